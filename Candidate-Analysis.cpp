@@ -2,10 +2,16 @@
 #include "DataParser.h"
 #include "DatabaseManager.h"
 #include "DataAnalyzer.h"
+#include "IngestPipeline.h"
+#include "Logger.h"
+#include "Metrics.h"
 #include "FilterManager.h"
 #include "PersistenceHandler.h"
 #include "ScoringEngine.h"
 #include "RankDialog.h"
+#include "CandidateListCtrl.h"
+#include <memory>
+#include <thread>
 #include <vector>
 #include <iostream>
 #include <chrono>
@@ -26,10 +32,14 @@ std::string getCurrentDate() {
     return ss.str();
 }
 
+// Posted from the ingest thread with an IngestProgress payload
+wxDEFINE_EVENT(wxEVT_INGEST_PROGRESS, wxThreadEvent);
+
 class MyApp : public wxApp
 {
 public:
     bool OnInit() override;
+    int OnExit() override;
 };
 
 wxIMPLEMENT_APP(MyApp);
@@ -39,6 +49,7 @@ class MyFrame : public wxFrame
 public:
     MyFrame();
     void PopulateCandidatesList();
+    void StartIngest(const std::vector<std::string>& urls);
 
 private:
     void OnSkillSelected(wxCommandEvent& event);
@@ -48,6 +59,11 @@ private:
 	void OnSaveButtonClicked(wxCommandEvent& event);
     void OnSavedFilterDoubleClick(wxListEvent& event);
     void OnRankButtonClicked(wxCommandEvent& event);
+    void LoadCurrentDay();
+    void RefreshStats();
+    void ReloadCandidates();
+    void OnIngestProgress(wxThreadEvent& event);
+    void OnClose(wxCloseEvent& event);
 
     wxTextCtrl* totalCandidates;
     wxListCtrl* universityStats;
@@ -59,7 +75,7 @@ private:
     wxCheckBox* skillsCheckBox;
     wxCheckBox* universityCheckBox;
     wxCheckBox* gpaCheckBox;
-    wxListCtrl* candidatesList;
+    CandidateListCtrl* candidatesList;
     wxListCtrl* savedFilters;
 	wxButton* clearButton;
     wxButton* saveButton;
@@ -67,6 +83,21 @@ private:
     wxWrapSizer* skillsWrapSizer;
     std::vector<wxStaticText*> selectedSkills;
     wxPanel* panel;
+
+    // Loaded candidates and the rows shown; candidatesList is a view of it
+    ResultSet results;
+
+    // Where the shown rows came from, so they can be reloaded after an ingest
+    enum class View { Today, Filtered, SavedFilter };
+    View view = View::Today;
+    FilterData activeFilter;   // Criteria of a Filtered view
+    bool rankApplied = false;  // The shown rows were ranked with rankWeights
+    ScoringWeights rankWeights;
+    size_t ingestRowsLoaded = 0; // Rows the running ingest had inserted or updated at the last reload
+
+    DataDownloader downloader;
+    std::unique_ptr<IngestPipeline> ingest;
+    std::thread ingestThread;
 };
 
 enum
@@ -76,6 +107,9 @@ enum
 
 bool MyApp::OnInit()
 {
+    // Ingest threads log from the hot path, so keep disk writes off them
+    Logger::getInstance().startAsync();
+
     MyFrame* frame = new MyFrame();
     frame->Show(true);
 
@@ -95,33 +129,24 @@ bool MyApp::OnInit()
         "https://chromium-case-study.s3.us-east-1.amazonaws.com/candidate+feeds/University-of-Havana.json"
     };
 
-    // Download data
-    DataDownloader downloader;
-    downloader.downloadAllFeedsAsync(urls);
-
-    // Batch insert with transaction  
-    std::string today = getCurrentDate();
-    for (const auto& url : urls) {
-        // Determine file type from URL
-        std::string fileType = downloader.getFileExtension(url);
-        // Create the appropriate parser
-        Parser* parser = ParserFactory::createParser(fileType);
-        if (parser) {
-            // Load parsed candidates from file  
-            std::string rawData = downloader.loadFile(downloader.url_to_filename(url));
-            std::string university = downloader.extractUniversityName(url);
-            auto candidates = parser->parse(rawData, university);
-            if (!db.insertCandidates(candidates, today)) {
-                delete parser; // Clean up the parser
-            }
-        }
-    }
-
+    // Show what is already stored for today, then download, parse and insert
+    // the feeds in the background; the list fills in as each feed lands
     frame->PopulateCandidatesList();
+    frame->StartIngest(urls);
 
     return true;
 }
 
+int MyApp::OnExit()
+{
+    // The frame has joined the ingest thread by now; write out what is still queued
+#if METRICS_ENABLED
+    Metrics::getInstance().writeJson("metrics.json");
+#endif
+    Logger::getInstance().shutdown();
+    return wxApp::OnExit();
+}
+
 MyFrame::MyFrame()
     : wxFrame(nullptr, wxID_ANY, "Candidate Analysis", wxDefaultPosition, wxSize(600, 800))
 {
@@ -200,12 +225,7 @@ MyFrame::MyFrame()
 
     mainSizer->Add(filtersSizer, 0, wxEXPAND | wxALL, 5);
 
-    candidatesList = new wxListCtrl(panel, wxID_ANY, wxDefaultPosition, wxSize(500, 100), wxLC_REPORT);
-    candidatesList->InsertColumn(0, "Name");
-    candidatesList->InsertColumn(1, "University");
-    candidatesList->InsertColumn(2, "Skills");
-    candidatesList->InsertColumn(3, "GPA");
-	candidatesList->InsertColumn(4, "Score");
+    candidatesList = new CandidateListCtrl(panel, wxSize(500, 100), results);
     mainSizer->Add(candidatesList, 0, wxEXPAND | wxALL, 5);
 
     wxStaticText* savedFiltersLabel = new wxStaticText(panel, wxID_ANY, "Saved Filters");
@@ -217,6 +237,7 @@ MyFrame::MyFrame()
     mainSizer->Add(savedFilters, 0, wxEXPAND | wxALL, 5);
 
     panel->SetSizer(mainSizer);
+    CreateStatusBar();
 	skillsInput->Bind(wxEVT_COMBOBOX, &MyFrame::OnSkillSelected, this);
     skillsCheckBox->Bind(wxEVT_CHECKBOX, &MyFrame::OnFilterChanged, this);
     universityCheckBox->Bind(wxEVT_CHECKBOX, &MyFrame::OnFilterChanged, this);
@@ -225,6 +246,77 @@ MyFrame::MyFrame()
 	saveButton->Bind(wxEVT_BUTTON, &MyFrame::OnSaveButtonClicked, this);
     savedFilters->Bind(wxEVT_LIST_ITEM_ACTIVATED, &MyFrame::OnSavedFilterDoubleClick, this);
 	rankButton->Bind(wxEVT_BUTTON, &MyFrame::OnRankButtonClicked, this);
+    Bind(wxEVT_INGEST_PROGRESS, &MyFrame::OnIngestProgress, this);
+    Bind(wxEVT_CLOSE_WINDOW, &MyFrame::OnClose, this);
+}
+
+void MyFrame::StartIngest(const std::vector<std::string>& urls)
+{
+    ingest.reset(new IngestPipeline(downloader, DatabaseManager::getInstance()));
+    ingest->setProgressCallback([this](const IngestProgress& progress) {
+        // Runs on the ingest thread; hand the update over to the GUI thread
+        wxThreadEvent* event = new wxThreadEvent(wxEVT_INGEST_PROGRESS);
+        event->SetPayload(progress);
+        wxQueueEvent(this, event);
+    });
+    std::string date = getCurrentDate();
+    ingestRowsLoaded = 0;
+    ingestThread = std::thread([this, urls, date]() {
+        if (!ingest->run(urls, date)) {
+            Logger::getInstance().log(LogLevel::Warning, "Some feeds could not be ingested");
+        }
+    });
+    SetStatusText("Downloading " + std::to_string(urls.size()) + " feeds...");
+}
+
+void MyFrame::OnIngestProgress(wxThreadEvent& event)
+{
+    IngestProgress progress = event.GetPayload<IngestProgress>();
+    std::string status = (progress.finished ? "Ingest finished: " : "Ingesting: ")
+        + std::to_string(progress.feedsDone) + "/" + std::to_string(progress.feedsTotal) + " feeds, "
+        + std::to_string(progress.rowsInserted) + " candidates inserted";
+    if (progress.rowsUpdated > 0 || progress.rowsDuplicate > 0) {
+        status += " (" + std::to_string(progress.rowsUpdated) + " updated, " + std::to_string(progress.rowsDuplicate) + " duplicates skipped)";
+    }
+    if (progress.feedsUnchanged > 0) {
+        status += ", " + std::to_string(progress.feedsUnchanged) + " unchanged";
+    }
+    if (progress.feedsFailed > 0 || progress.rowsFailed > 0) {
+        status += ", " + std::to_string(progress.feedsFailed) + " feeds failed, " + std::to_string(progress.rowsFailed) + " candidates rejected";
+    }
+    SetStatusText(status);
+
+    // The list fills in as each feed lands: the stats come from the summary
+    // tables and the rows are reloaded in the current view, keeping the filter
+    // and ranking. Feeds that were unchanged or failed add no rows to reload.
+    if (progress.feedFinished || progress.finished) {
+        RefreshStats();
+        size_t rowsChanged = progress.rowsInserted + progress.rowsUpdated;
+        if (rowsChanged != ingestRowsLoaded) {
+            ingestRowsLoaded = rowsChanged;
+            ReloadCandidates();
+        }
+    }
+#if METRICS_ENABLED
+    // Snapshot of the ingest stages while the session goes on
+    if (progress.finished) {
+        Metrics::getInstance().writeJson("metrics.json");
+    }
+#endif
+}
+
+void MyFrame::OnClose(wxCloseEvent& event)
+{
+    // Stop a running ingest before the frame goes away. cancel() aborts the
+    // downloads in flight and their backoff waits, so the join only waits
+    // for the batch being written.
+    if (ingest) {
+        ingest->cancel();
+    }
+    if (ingestThread.joinable()) {
+        ingestThread.join();
+    }
+    event.Skip();
 }
 
 void MyFrame::OnRankButtonClicked(wxCommandEvent& event)
@@ -243,40 +335,11 @@ void MyFrame::OnRankButtonClicked(wxCommandEvent& event)
 
     RankDialog rankDialog(this, skills, universities, weights);
     if (rankDialog.ShowModal() == wxID_OK) {
-        ScoringEngine engine;
-		// Get the current content of candidatesList and store it in a vector
-		std::vector<Candidate> candidates;
-        for (int i = 0; i < candidatesList->GetItemCount(); i++) {
-            Candidate c;
-            c.name = candidatesList->GetItemText(i, 0).ToStdString();
-            c.university = candidatesList->GetItemText(i, 1).ToStdString();
-            c.gpa = std::stod(candidatesList->GetItemText(i, 3).ToStdString());
-            std::string skills = candidatesList->GetItemText(i, 2).ToStdString();
-            std::stringstream ss(skills);
-            std::string skill;
-            while (std::getline(ss, skill, ',')) {
-                c.skills.push_back(skill);
-            }
-            candidates.push_back(c);
-        }
-		// Reorder the candidates based on the new ranking
-		std::vector<Candidate> rankedCandidates = engine.rankCandidates(candidates, weights);
-		// Update the candidatesList with the new ranking
-		candidatesList->DeleteAllItems();
-        for (const auto& candidate : rankedCandidates) {
-            long index = candidatesList->InsertItem(candidatesList->GetItemCount(), candidate.name);
-            candidatesList->SetItem(index, 1, candidate.university);
-            std::string skills;
-            for (const auto& skill : candidate.skills) {
-                if (!skills.empty()) {
-                    skills += ", ";
-                }
-                skills += skill;
-            }
-            candidatesList->SetItem(index, 2, wxString::FromUTF8(skills.c_str()));
-            candidatesList->SetItem(index, 3, std::to_string(candidate.gpa));
-            candidatesList->SetItem(index, 4, std::to_string(candidate.score));
-        }
+		// Rank the rows currently shown; re-ranking them only applies the changed weights
+		results.rank(weights);
+		rankApplied = true;
+		rankWeights = weights;
+		candidatesList->RefreshRows();
     }
 }
 
@@ -328,24 +391,11 @@ void MyFrame::OnSavedFilterDoubleClick(wxListEvent& event)
 		maxGPAInput->SetValue(std::to_string(filterData.maxGPA));
 	}
 
-    // Update the candidate list
-    candidatesList->DeleteAllItems();
-    for (const auto& candidate : candidates) {
-        long index = candidatesList->InsertItem(candidatesList->GetItemCount(), candidate.name);
-        candidatesList->SetItem(index, 1, candidate.university);
-
-        // Join all skills into a single string separated by commas
-        std::string skills;
-        for (const auto& skill : candidate.skills) {
-            if (!skills.empty()) {
-                skills += ", ";
-            }
-            skills += skill;
-        }
-        candidatesList->SetItem(index, 2, wxString::FromUTF8(skills.c_str()));
-        candidatesList->SetItem(index, 3, std::to_string(candidate.gpa));
-		candidatesList->SetItem(index, 4, std::to_string(candidate.score));
-    }
+    // Show the saved candidates; filtering or clearing goes back to today's data
+    results.load(candidates);
+    view = View::SavedFilter;
+    rankApplied = false;
+    candidatesList->RefreshRows();
 }
 
 void MyFrame::OnSaveButtonClicked(wxCommandEvent& event)
@@ -375,21 +425,8 @@ void MyFrame::OnSaveButtonClicked(wxCommandEvent& event)
 			filterData.minGPA = minGPA;
 			filterData.maxGPA = maxGPA;
 		}
-		// Retrieve the current candidates inside candidatesList
-		std::vector<Candidate> candidates;
-		for (int i = 0; i < candidatesList->GetItemCount(); i++) {
-			Candidate c;
-			c.name = candidatesList->GetItemText(i, 0).ToStdString();
-			c.university = candidatesList->GetItemText(i, 1).ToStdString();
-			c.gpa = std::stod(candidatesList->GetItemText(i, 3).ToStdString());
-			std::string skills = candidatesList->GetItemText(i, 2).ToStdString();
-			std::stringstream ss(skills);
-			std::string skill;
-			while (std::getline(ss, skill, ',')) {
-				c.skills.push_back(skill);
-			}
-			candidates.push_back(c);
-		}
+		// Save the candidates currently shown
+		std::vector<Candidate> candidates = results.toCandidates();
 		PersistenceHandler handler;
 		if (handler.saveToFile(candidates, filterName + ".json", filterData)) {
 			// Update the saved filters list
@@ -425,43 +462,23 @@ void MyFrame::OnClearButtonClicked(wxCommandEvent& event)
     skillsWrapSizer->Layout();
     panel->Layout();
 
-    DatabaseManager& db = DatabaseManager::getInstance();
-    std::vector<Candidate> candidates = db.getCandidatesByDate(getCurrentDate());
-
-    // Update the candidate list
-    candidatesList->DeleteAllItems();
-    for (const auto& candidate : candidates) {
-        long index = candidatesList->InsertItem(candidatesList->GetItemCount(), candidate.name);
-        candidatesList->SetItem(index, 1, candidate.university);
-
-        // Join all skills into a single string separated by commas
-        std::string skills;
-        for (const auto& skill : candidate.skills) {
-            if (!skills.empty()) {
-                skills += ", ";
-            }
-            skills += skill;
-        }
-        candidatesList->SetItem(index, 2, wxString::FromUTF8(skills.c_str()));
-        candidatesList->SetItem(index, 3, std::to_string(candidate.gpa));
-		candidatesList->SetItem(index, 4, std::to_string(candidate.score));
-    }
+    // Show all of today's candidates again
+    LoadCurrentDay();
+    candidatesList->RefreshRows();
 }
 
 void MyFrame::OnFilterChanged(wxCommandEvent& event)
 {
-    DatabaseManager& db = DatabaseManager::getInstance();
-    FilterManager filter;
-
-    std::vector<Candidate> candidates = db.getCandidatesByDate(getCurrentDate());
+    // Collect the criteria; they are compiled into a single query
+    FilterData filterData;
+    filterData.date = getCurrentDate();
 
     if (skillsCheckBox->IsChecked()) {
-        std::vector<std::string> selectedSkillsList;
         for (const auto& skillText : selectedSkills) {
-            selectedSkillsList.push_back(std::string(skillText->GetLabel().mb_str()));
+            filterData.skills.push_back(std::string(skillText->GetLabel().mb_str()));
         }
-        if (!selectedSkillsList.empty()) {
-            candidates = filter.filterBySkills(candidates, selectedSkillsList);
+        if (!filterData.skills.empty()) {
+            filterData.skillsChecked = true;
 		}
         else {
             wxMessageBox("Please select a skill", "Validation Error", wxOK | wxICON_ERROR);
@@ -474,7 +491,8 @@ void MyFrame::OnFilterChanged(wxCommandEvent& event)
     if (universityCheckBox->IsChecked()) {
         wxString selectedUniversity = universityInput->GetValue();
         if (!selectedUniversity.IsEmpty()) {
-            candidates = filter.filterByUniversity(candidates, selectedUniversity.ToStdString());
+            filterData.universityChecked = true;
+            filterData.university = selectedUniversity.ToStdString();
 		}
         else {
             wxMessageBox("Please select a university", "Validation Error", wxOK | wxICON_ERROR);
@@ -493,7 +511,9 @@ void MyFrame::OnFilterChanged(wxCommandEvent& event)
 				gpaCheckBox->SetValue(false);
                 return;
             }
-            candidates = filter.filterByGPA(candidates, minGPA, maxGPA);
+            filterData.gpaChecked = true;
+            filterData.minGPA = minGPA;
+            filterData.maxGPA = maxGPA;
         }
         else {
             wxMessageBox("Please enter valid GPA values", "Validation Error", wxOK | wxICON_ERROR);
@@ -503,6 +523,9 @@ void MyFrame::OnFilterChanged(wxCommandEvent& event)
         }
     }
 
+    // Only the matching rows leave the database; rank and save then work on them
+    std::vector<Candidate> candidates = DatabaseManager::getInstance().queryCandidates(filterData);
+
 	// Check if candidates is empty
 	if (candidates.empty()) {
 		wxMessageBox("No candidates found", "Validation Error", wxOK | wxICON_ERROR);
@@ -514,23 +537,11 @@ void MyFrame::OnFilterChanged(wxCommandEvent& event)
 	}
 
     // Update candidatesList with candidates
-    candidatesList->DeleteAllItems();
-    for (const auto& candidate : candidates) {
-        long index = candidatesList->InsertItem(candidatesList->GetItemCount(), candidate.name);
-        candidatesList->SetItem(index, 1, candidate.university);
-
-        // Join all skills into a single string separated by commas
-        std::string skills;
-        for (const auto& skill : candidate.skills) {
-            if (!skills.empty()) {
-                skills += ", ";
-            }
-            skills += skill;
-        }
-        candidatesList->SetItem(index, 2, wxString::FromUTF8(skills.c_str()));
-        candidatesList->SetItem(index, 3, std::to_string(candidate.gpa));
-		candidatesList->SetItem(index, 4, std::to_string(candidate.score));
-    }
+    results.load(candidates);
+    view = View::Filtered;
+    activeFilter = filterData;
+    rankApplied = false;
+    candidatesList->RefreshRows();
 }
 
 void MyFrame::OnSkillSelected(wxCommandEvent& event)
@@ -561,62 +572,77 @@ void MyFrame::OnSkillDoubleClick(wxMouseEvent& event)
 }
 
 void MyFrame::PopulateCandidatesList()
+{
+    RefreshStats();
+    LoadCurrentDay();
+    candidatesList->RefreshRows();
+}
+
+void MyFrame::RefreshStats()
 {
     DatabaseManager& db = DatabaseManager::getInstance();
     DataAnalyzer analyzer;
 
-    std::vector<Candidate> candidates = db.getCandidatesByDate(getCurrentDate());
+    // Stats come from the summary tables maintained at insert time
+    std::string date = getCurrentDate();
+    AnalysisResult analysis = analyzer.summarize(db.getUniversitySummary(date), db.getSkillCounts(date));
 
     // Populate totalCandidates
-	int total = analyzer.getTotalCandidates(candidates);
-    totalCandidates->SetValue(std::to_string(total));
+    totalCandidates->SetValue(std::to_string(analysis.totalCandidates));
 
     // Populate universityStats
     universityStats->DeleteAllItems();
-    auto universityData = analyzer.getUniversityStats(candidates);
+    const auto& universityData = analysis.universityStats;
     for (const auto& entry : universityData) {
         long index = universityStats->InsertItem(universityStats->GetItemCount(), entry.first);
         universityStats->SetItem(index, 1, std::to_string(entry.second.totalCandidates));
         universityStats->SetItem(index, 2, std::to_string(entry.second.averageGpa));
     }
 
-	// Populate universityInput
-	universityInput->Clear();
+	// Add new universities to universityInput without touching the current choice
 	for (const auto& entry : universityData) {
-		universityInput->Append(entry.first);
+		if (universityInput->FindString(entry.first, true) == wxNOT_FOUND) {
+			universityInput->Append(entry.first);
+		}
 	}
 
     // Populate skillsStats
     skillsStats->DeleteAllItems();
-    auto skillsData = analyzer.getSkillsStats(candidates);
+    const auto& skillsData = analysis.skillsStats;
     for (const auto& entry : skillsData) {
         long index = skillsStats->InsertItem(skillsStats->GetItemCount(), entry.first);
         skillsStats->SetItem(index, 1, std::to_string(entry.second));
     }
 
-    // Populate skillsInput
-    skillsInput->Clear();
+    // Add new skills to skillsInput
     for (const auto& entry : skillsData) {
-        skillsInput->Append(entry.first);
-    }
-
-    // Populate candidatesList
-    candidatesList->DeleteAllItems();
-    for (const auto& candidate : candidates) {
-        long index = candidatesList->InsertItem(candidatesList->GetItemCount(), candidate.name);
-        candidatesList->SetItem(index, 1, candidate.university);
-
-        // Join all skills into a single string separated by commas
-        std::string skills;
-        for (const auto& skill : candidate.skills) {
-            if (!skills.empty()) {
-                skills += ", ";
-            }
-            skills += skill;
+        if (skillsInput->FindString(entry.first, true) == wxNOT_FOUND) {
+            skillsInput->Append(entry.first);
         }
-        candidatesList->SetItem(index, 2, wxString::FromUTF8(skills.c_str()));
-        candidatesList->SetItem(index, 3, std::to_string(candidate.gpa));
-		candidatesList->SetItem(index, 4, std::to_string(candidate.score));
     }
+}
 
-}
\ No newline at end of file
+void MyFrame::LoadCurrentDay()
+{
+    DatabaseManager& db = DatabaseManager::getInstance();
+    results.load(db.getCandidatesByDate(getCurrentDate()));
+    view = View::Today;
+    rankApplied = false;
+}
+
+// Picks up the rows added by an ingest in the current view; a saved filter is a snapshot and stays as it is
+void MyFrame::ReloadCandidates()
+{
+    if (view == View::SavedFilter) return;
+    DatabaseManager& db = DatabaseManager::getInstance();
+    if (view == View::Filtered) {
+        results.load(db.queryCandidates(activeFilter));
+    }
+    else {
+        results.load(db.getCandidatesByDate(getCurrentDate()));
+    }
+    if (rankApplied) {
+        results.rank(rankWeights);
+    }
+    candidatesList->RefreshRows();
+}
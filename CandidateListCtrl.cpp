@@ -0,0 +1,50 @@
+#include "CandidateListCtrl.h"
+#include <string>
+
+CandidateListCtrl::CandidateListCtrl(wxWindow* parent, const wxSize& size, const ResultSet& results)
+    : wxListCtrl(parent, wxID_ANY, wxDefaultPosition, size, wxLC_REPORT | wxLC_VIRTUAL), results(results)
+{
+    InsertColumn(0, "Name");
+    InsertColumn(1, "University");
+    InsertColumn(2, "Skills");
+    InsertColumn(3, "GPA");
+    InsertColumn(4, "Score");
+}
+
+void CandidateListCtrl::RefreshRows()
+{
+    SetItemCount(static_cast<long>(results.size()));
+    Refresh();
+}
+
+wxString CandidateListCtrl::OnGetItemText(long item, long column) const
+{
+    if (item < 0 || static_cast<size_t>(item) >= results.size()) {
+        return wxString();
+    }
+    const CandidateStore& store = results.store();
+    RowIndex row = results.rows()[item];
+    switch (column) {
+    case 0:
+        return store.name(row);
+    case 1:
+        return store.university(row);
+    case 2: {
+        // Join all skills into a single string separated by commas
+        std::string skills;
+        for (const uint32_t* it = store.skillsBegin(row); it != store.skillsEnd(row); ++it) {
+            if (!skills.empty()) {
+                skills += ", ";
+            }
+            skills += store.skills().get(*it);
+        }
+        return wxString::FromUTF8(skills.c_str());
+    }
+    case 3:
+        return std::to_string(store.gpa(row));
+    case 4:
+        return std::to_string(results.score(row));
+    default:
+        return wxString();
+    }
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include "ResultSet.h"
+#include <wx/wx.h>
+#include <wx/listctrl.h>
+
+// Virtual (wxLC_VIRTUAL) report list showing a ResultSet. The control only
+// stores the row count and asks OnGetItemText for the cells it paints, so
+// skills are joined and numbers formatted for visible rows only.
+class CandidateListCtrl : public wxListCtrl
+{
+public:
+    CandidateListCtrl(wxWindow* parent, const wxSize& size, const ResultSet& results);
+
+    // Call after the result set changes
+    void RefreshRows();
+
+protected:
+    wxString OnGetItemText(long item, long column) const override;
+
+private:
+    const ResultSet& results;
+};
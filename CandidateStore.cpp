@@ -0,0 +1,83 @@
+#include "CandidateStore.h"
+
+uint32_t StringDictionary::intern(const std::string& value) {
+    auto it = ids.find(value);
+    if (it != ids.end()) return it->second;
+    uint32_t id = static_cast<uint32_t>(values.size());
+    values.push_back(value);
+    ids.emplace(value, id);
+    return id;
+}
+
+bool StringDictionary::find(const std::string& value, uint32_t& id) const {
+    auto it = ids.find(value);
+    if (it == ids.end()) return false;
+    id = it->second;
+    return true;
+}
+
+CandidateStore::CandidateStore() : nameOffsets(1, 0), skillOffsets(1, 0) {}
+
+CandidateStore::CandidateStore(const std::vector<Candidate>& candidates) : CandidateStore() {
+    reserve(candidates.size());
+    for (const auto& c : candidates) {
+        add(c);
+    }
+}
+
+void CandidateStore::reserve(size_t rows, size_t skillsPerRow) {
+    nameOffsets.reserve(rows + 1);
+    gpaColumn.reserve(rows);
+    universityColumn.reserve(rows);
+    skillOffsets.reserve(rows + 1);
+    skillIdColumn.reserve(rows * skillsPerRow);
+}
+
+RowIndex CandidateStore::add(const Candidate& candidate) {
+    RowIndex row = static_cast<RowIndex>(size());
+    nameChars += candidate.name;
+    nameOffsets.push_back(static_cast<uint32_t>(nameChars.size()));
+    gpaColumn.push_back(candidate.gpa);
+    universityColumn.push_back(universityDict.intern(candidate.university));
+    for (const auto& skill : candidate.skills) {
+        skillIdColumn.push_back(skillDict.intern(skill));
+    }
+    skillOffsets.push_back(static_cast<uint32_t>(skillIdColumn.size()));
+    return row;
+}
+
+void CandidateStore::clear() {
+    *this = CandidateStore();
+}
+
+Selection CandidateStore::allRows() const {
+    Selection rows(size());
+    for (size_t i = 0; i < rows.size(); ++i) {
+        rows[i] = static_cast<RowIndex>(i);
+    }
+    return rows;
+}
+
+std::string CandidateStore::name(RowIndex row) const {
+    return nameChars.substr(nameOffsets[row], nameOffsets[row + 1] - nameOffsets[row]);
+}
+
+Candidate CandidateStore::toCandidate(RowIndex row) const {
+    Candidate c;
+    c.name = name(row);
+    c.gpa = gpa(row);
+    c.university = university(row);
+    for (const uint32_t* it = skillsBegin(row); it != skillsEnd(row); ++it) {
+        c.skills.push_back(skillDict.get(*it));
+    }
+    return c;
+}
+
+std::vector<Candidate> CandidateStore::toCandidates(const Selection& rows) const {
+    std::vector<Candidate> candidates;
+    candidates.reserve(rows.size());
+    for (RowIndex row : rows) {
+        candidates.push_back(toCandidate(row));
+    }
+    return candidates;
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include "DataParser.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using RowIndex = uint32_t;
+using Selection = std::vector<RowIndex>; // Row indices into a CandidateStore
+
+// Maps each distinct string to a dense id, starting at 0
+class StringDictionary {
+public:
+    uint32_t intern(const std::string& value);
+    bool find(const std::string& value, uint32_t& id) const;
+    const std::string& get(uint32_t id) const { return values[id]; }
+    size_t size() const { return values.size(); }
+
+private:
+    std::vector<std::string> values;
+    std::unordered_map<std::string, uint32_t> ids;
+};
+
+// Column-oriented (structure-of-arrays) candidate table. Names are packed into
+// one character buffer, universities and skills are interned, and each row's
+// skills are a slice of skillIds given by skillOffsets (CSR layout). Rows are
+// addressed by index so filters, ranking and stats never copy candidates.
+class CandidateStore {
+public:
+    CandidateStore();
+    explicit CandidateStore(const std::vector<Candidate>& candidates);
+
+    void reserve(size_t rows, size_t skillsPerRow = 4);
+    RowIndex add(const Candidate& candidate);
+    void clear();
+
+    size_t size() const { return gpaColumn.size(); }
+    Selection allRows() const;
+
+    std::string name(RowIndex row) const;
+    double gpa(RowIndex row) const { return gpaColumn[row]; }
+    uint32_t universityId(RowIndex row) const { return universityColumn[row]; }
+    const std::string& university(RowIndex row) const { return universityDict.get(universityColumn[row]); }
+    const uint32_t* skillsBegin(RowIndex row) const { return skillIdColumn.data() + skillOffsets[row]; }
+    const uint32_t* skillsEnd(RowIndex row) const { return skillIdColumn.data() + skillOffsets[row + 1]; }
+    size_t skillCount(RowIndex row) const { return skillOffsets[row + 1] - skillOffsets[row]; }
+
+    const std::vector<double>& gpas() const { return gpaColumn; }
+    const std::vector<uint32_t>& universityIds() const { return universityColumn; }
+    const StringDictionary& universities() const { return universityDict; }
+    const StringDictionary& skills() const { return skillDict; }
+
+    Candidate toCandidate(RowIndex row) const;
+    std::vector<Candidate> toCandidates(const Selection& rows) const;
+
+private:
+    std::string nameChars;
+    std::vector<uint32_t> nameOffsets;  // size() + 1 entries
+    std::vector<double> gpaColumn;
+    std::vector<uint32_t> universityColumn;
+    std::vector<uint32_t> skillOffsets; // size() + 1 entries
+    std::vector<uint32_t> skillIdColumn;
+    StringDictionary universityDict;
+    StringDictionary skillDict;
+};
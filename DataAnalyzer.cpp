@@ -1,28 +1,43 @@
 #include "DataAnalyzer.h"
+#include "Metrics.h"
 #include <numeric>
 #include <algorithm>
+#include <unordered_map>
+
+namespace {
+
+struct UniversityTotals {
+    int count = 0;
+    double gpaSum = 0.0;
+};
+
+// Most frequent first, then by name, so every overload lists ties the same way
+std::vector<std::pair<std::string, int>> sortSkills(std::vector<std::pair<std::string, int>> skills) {
+    std::sort(skills.begin(), skills.end(), [](const auto& a, const auto& b) {
+        if (a.second != b.second) return a.second > b.second;
+        return a.first < b.first;
+    });
+    return skills;
+}
+
+}
 
 int DataAnalyzer::getTotalCandidates(const std::vector<Candidate>& candidates) {
     return candidates.size();
 }
 
 std::map<std::string, UniversityStats> DataAnalyzer::getUniversityStats(const std::vector<Candidate>& candidates) {
-    std::map<std::string, UniversityStats> stats;
-    std::map<std::string, std::vector<double>> gpaMap;
-
+    // Running sums per university instead of collecting every GPA
+    std::unordered_map<std::string, UniversityTotals> totals;
     for (const auto& c : candidates) {
-        stats[c.university].totalCandidates++;
-        gpaMap[c.university].push_back(c.gpa);
+        totals[c.university].count++;
+        totals[c.university].gpaSum += c.gpa;
     }
 
-    // Calculate average GPA per university
-    for (auto& pair : gpaMap) {
-        const std::string& uni = pair.first;
-        std::vector<double>& data = pair.second;
-        double sum = std::accumulate(data.begin(), data.end(), 0.0);
-        stats[uni].averageGpa = sum / data.size();
+    std::map<std::string, UniversityStats> stats;
+    for (const auto& entry : totals) {
+        stats[entry.first] = UniversityStats{ entry.second.count, entry.second.gpaSum / entry.second.count };
     }
-
     return stats;
 }
 
@@ -35,10 +50,55 @@ std::vector<std::pair<std::string, int>> DataAnalyzer::getSkillsStats(const std:
     }
 
     // Sort skills by frequency
-    std::vector<std::pair<std::string, int>> sortedSkills(skillCounts.begin(), skillCounts.end());
-    std::sort(sortedSkills.begin(), sortedSkills.end(),
-        [](const auto& a, const auto& b) { return a.second > b.second; });
+    std::vector<std::pair<std::string, int>> sortedSkills = sortSkills(std::vector<std::pair<std::string, int>>(skillCounts.begin(), skillCounts.end()));
 
     //if (sortedSkills.size() > topN) sortedSkills.resize(topN);
     return sortedSkills;
+}
+
+int DataAnalyzer::getTotalCandidates(const CandidateStore&, const Selection& rows) {
+    return static_cast<int>(rows.size());
+}
+
+std::map<std::string, UniversityStats> DataAnalyzer::getUniversityStats(const CandidateStore& store, const Selection& rows) {
+    std::vector<int> counts(store.universities().size(), 0);
+    std::vector<double> gpaSums(store.universities().size(), 0.0);
+    for (RowIndex row : rows) {
+        counts[store.universityId(row)]++;
+        gpaSums[store.universityId(row)] += store.gpa(row);
+    }
+
+    std::map<std::string, UniversityStats> stats;
+    for (uint32_t id = 0; id < counts.size(); ++id) {
+        if (counts[id] == 0) continue;
+        stats[store.universities().get(id)] = UniversityStats{ counts[id], gpaSums[id] / counts[id] };
+    }
+    return stats;
+}
+
+std::vector<std::pair<std::string, int>> DataAnalyzer::getSkillsStats(const CandidateStore& store, const Selection& rows) {
+    std::vector<int> counts(store.skills().size(), 0);
+    for (RowIndex row : rows) {
+        for (const uint32_t* it = store.skillsBegin(row); it != store.skillsEnd(row); ++it) {
+            counts[*it]++;
+        }
+    }
+
+    std::vector<std::pair<std::string, int>> sortedSkills;
+    for (uint32_t id = 0; id < counts.size(); ++id) {
+        if (counts[id] > 0) sortedSkills.emplace_back(store.skills().get(id), counts[id]);
+    }
+    return sortSkills(std::move(sortedSkills));
+}
+
+AnalysisResult DataAnalyzer::summarize(const std::vector<UniversitySummary>& universities, const std::vector<std::pair<std::string, int>>& skills) {
+    METRICS_TIMER("analyze_us");
+    AnalysisResult result;
+    for (const auto& entry : universities) {
+        if (entry.candidates <= 0) continue;
+        result.totalCandidates += entry.candidates;
+        result.universityStats[entry.university] = UniversityStats{ entry.candidates, entry.gpaSum / entry.candidates };
+    }
+    result.skillsStats = sortSkills(skills);
+    return result;
 }
\ No newline at end of file
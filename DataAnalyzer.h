@@ -1,4 +1,5 @@
 #pragma once
+#include "CandidateStore.h"
 #include "DatabaseManager.h"
 #include <map>
 #include <vector>
@@ -8,9 +9,24 @@ struct UniversityStats {
     double averageGpa;
 };
 
+// Everything the stats panel shows
+struct AnalysisResult {
+    int totalCandidates = 0;
+    std::map<std::string, UniversityStats> universityStats;
+    std::vector<std::pair<std::string, int>> skillsStats; // Most frequent first, then by name
+};
+
 class DataAnalyzer {
 public:
     static int getTotalCandidates(const std::vector<Candidate>& candidates);
     static std::map<std::string, UniversityStats> getUniversityStats(const std::vector<Candidate>& candidates);
     static std::vector<std::pair<std::string, int>> getSkillsStats(const std::vector<Candidate>& candidates);
+
+    // CandidateStore overloads: aggregate over a selection of rows using dense id-indexed arrays
+    static int getTotalCandidates(const CandidateStore& store, const Selection& rows);
+    static std::map<std::string, UniversityStats> getUniversityStats(const CandidateStore& store, const Selection& rows);
+    static std::vector<std::pair<std::string, int>> getSkillsStats(const CandidateStore& store, const Selection& rows);
+    // Total, per-university count/mean GPA and skill frequencies from the
+    // database summary tables, O(universities + skills)
+    static AnalysisResult summarize(const std::vector<UniversitySummary>& universities, const std::vector<std::pair<std::string, int>>& skills);
 };
\ No newline at end of file
@@ -1,8 +1,16 @@
 #include "DataDownloader.h"  
+#include "DatabaseManager.h"
 #include "Logger.h"  
+#include "MappedFile.h"
+#include "Metrics.h"
 #include <cpprest/http_client.h>  
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <fstream>
-#include <future>  
+#include <functional>
+#include <random>
+#include <thread>
 #include <vector>  
 #include <locale>
 #include <codecvt>
@@ -20,9 +28,9 @@ std::string DataDownloader::getFileExtension(const std::string& filename) {
     return ""; // Return an empty string if no extension is 
 }
 
-// Function to save data to a file
+// Function to save data to a file; binary, so the bytes land as downloaded
 void DataDownloader::saveToFile(const std::string& filename, const std::string& data) {
-    std::ofstream file(filename);
+    std::ofstream file(filename, std::ios::binary);
     if (file.is_open()) {
         file << data;
         file.close();
@@ -32,12 +40,11 @@ void DataDownloader::saveToFile(const std::string& filename, const std::string&
     }
 }
 
-// Function to load file content
+// Function to load file content; binary, so embedded NULs and CRLFs are kept
 std::string DataDownloader::loadFile(const std::string& filename) {
-    std::ifstream file(filename);
-	std::vector <char> buffer((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-	buffer.push_back('\0');
-	return buffer.data();
+    MappedFile file;
+    if (!file.open(filename)) return "";
+    return std::string(file.data(), file.size());
 }
 
 // Function to convert URL to filename (example implementation)
@@ -65,35 +72,263 @@ std::string DataDownloader::extractUniversityName(const std::string& url) {
     return "";
 }
 
-// Thread-safe download with retries
-void DataDownloader::downloadFeedWithRetry(const std::string& url, int maxRetries) {
+static const uint64_t fnvOffset = 14695981039346656037ULL;
+
+// 64-bit FNV-1a, continued from hash over size more bytes
+static uint64_t hashBytes(uint64_t hash, const char* data, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static std::string hashToHex(uint64_t hash) {
+    static const char digits[] = "0123456789abcdef";
+    std::string hex(16, '0');
+    for (int i = 15; i >= 0; --i, hash >>= 4) {
+        hex[i] = digits[hash & 0xF];
+    }
+    return hex;
+}
+
+// 64-bit FNV-1a of the body as hex; only used to detect changed feeds
+std::string DataDownloader::contentHash(const std::string& data) {
+    return hashToHex(hashBytes(fnvOffset, data.data(), data.size()));
+}
+
+namespace {
+
+// std::streambuf over an HTTP response body. Holds one chunk at a time, so
+// reading a feed of any size takes chunkSize bytes here, and hashes the bytes
+// as they pass. Read errors end the stream and are kept in error().
+class BodyStreambuf : public std::streambuf {
+public:
+    BodyStreambuf(concurrency::streams::streambuf<uint8_t> body, size_t chunkSize)
+        : body(body), chunk(std::max<size_t>(chunkSize, 1)), hash(fnvOffset) {}
+
+    uint64_t contentHash() const { return hash; }
+    const std::string& error() const { return readError; }
+
+protected:
+    int_type underflow() override {
+        if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+        size_t read = 0;
+        try {
+            read = body.getn(reinterpret_cast<uint8_t*>(chunk.data()), chunk.size()).get();
+        }
+        catch (const std::exception& e) {
+            readError = e.what();
+        }
+        if (read == 0) return traits_type::eof();
+        hash = hashBytes(hash, chunk.data(), read);
+        METRICS_COUNT("bytes_downloaded", read);
+        setg(chunk.data(), chunk.data(), chunk.data() + read);
+        return traits_type::to_int_type(*gptr());
+    }
+
+private:
+    concurrency::streams::streambuf<uint8_t> body;
+    std::vector<char> chunk;
+    uint64_t hash;
+    std::string readError;
+};
+
+}
+
+// Client for the scheme, host and port of uri, created on first use and shared
+// by every thread; http_client accepts concurrent requests
+std::shared_ptr<http_client> DataDownloader::clientFor(const uri& target) {
+    uri authority = target.authority();
+    std::string key = utility::conversions::to_utf8string(authority.to_string());
+    std::lock_guard<std::mutex> lock(clientsMutex);
+    auto& client = clients[key];
+    if (!client) {
+        http_client_config config;
+        config.set_timeout(options.timeout);
+        client = std::make_shared<http_client>(authority, config);
+    }
+    return client;
+}
+
+// Exponential backoff with "equal jitter": half the delay is fixed, the other
+// half random, so retries of feeds that failed together spread out
+std::chrono::milliseconds DataDownloader::backoffDelay(int retry) {
+    thread_local std::mt19937 random(std::random_device{}());
+    long long delay = options.initialBackoff.count();
+    for (int i = 1; i < retry && delay < options.maxBackoff.count(); ++i) {
+        delay *= 2;
+    }
+    delay = std::min<long long>(delay, options.maxBackoff.count());
+    std::uniform_int_distribution<long long> jitter(0, delay / 2);
+    return std::chrono::milliseconds(delay - delay / 2 + jitter(random));
+}
+
+// Sleeps before attempt retry (none before the first); false once the downloader is cancelled
+bool DataDownloader::waitBackoff(int retry) {
+    std::chrono::milliseconds delay = retry > 0 ? backoffDelay(retry) : std::chrono::milliseconds(0);
+    std::unique_lock<std::mutex> lock(cancelMutex);
+    return !cancelWake.wait_for(lock, delay, [this] { return cancelled; });
+}
+
+void DataDownloader::cancel() {
+    {
+        std::lock_guard<std::mutex> lock(cancelMutex);
+        cancelled = true;
+    }
+    cancelWake.notify_all();
+    cancellation.cancel();
+}
+
+// Thread-safe download with retries, keeping the body in memory
+bool DataDownloader::fetchFeed(const std::string& url, int maxRetries, std::string& data) {
+    FeedState state; // No validators, so the body is always downloaded
+    return fetchFeedIfChanged(url, maxRetries, state, data).result == FetchResult::Downloaded;
+}
+
+// Conditional download with retries. A server that ignores the validators
+// still answers 200, so the body is hashed and compared as well.
+FetchOutcome DataDownloader::fetchFeedIfChanged(const std::string& url, int maxRetries, FeedState& state, std::string& data) {
+    std::string previousHash = state.contentHash;
+    FetchOutcome outcome = streamFeedIfChanged(url, maxRetries, state, [&data](std::istream& body) {
+        data.assign(std::istreambuf_iterator<char>(body), std::istreambuf_iterator<char>());
+    });
+    if (outcome.result == FetchResult::Downloaded && !previousHash.empty() && state.contentHash == previousHash) {
+        Logger::getInstance().log(LogLevel::Info, "Unchanged: " + url);
+        data.clear();
+        outcome.result = FetchResult::Unchanged;
+    }
+    return outcome;
+}
+
+// The body is read as raw bytes, without the UTF-16 round trip of
+// extract_string(). Attempts are only retried until the body starts flowing;
+// a body that breaks off later fails the download after consume returns.
+FetchOutcome DataDownloader::streamFeedIfChanged(const std::string& url, int maxRetries, FeedState& state, const BodyConsumer& consume) {
+    METRICS_TIMER("download_us");
+    FetchOutcome outcome;
+    outcome.url = url;
+    auto start = std::chrono::steady_clock::now();
+    auto finish = [&outcome, start](FetchResult result) {
+        outcome.result = result;
+        if (result == FetchResult::Failed) METRICS_COUNT("downloads_failed", 1);
+        outcome.elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+        return outcome;
+    };
+
     for (int i = 0; i < maxRetries; ++i) {
+        if (!waitBackoff(i)) {
+            outcome.error = "Cancelled";
+            Logger::getInstance().log(LogLevel::Info, "Download cancelled: " + url);
+            return finish(FetchResult::Failed);
+        }
+        outcome.attempts++;
+        bool retryable = true;
         try {
-            http_client client(utility::conversions::to_string_t(url));
-            auto response = client.request(methods::GET).get();
+            uri target(utility::conversions::to_string_t(url));
+            http_request request(methods::GET);
+            request.set_request_uri(target.resource());
+            if (!state.etag.empty()) {
+                request.headers().add(header_names::if_none_match, utility::conversions::to_string_t(state.etag));
+            }
+            if (!state.lastModified.empty()) {
+                request.headers().add(header_names::if_modified_since, utility::conversions::to_string_t(state.lastModified));
+            }
+            // Cancelling aborts the request, including a body still being read
+            auto response = clientFor(target)->request(request, cancellation.get_token()).get();
+            outcome.statusCode = response.status_code();
+            if (response.status_code() == status_codes::NotModified) {
+                Logger::getInstance().log(LogLevel::Info, "Not modified: " + url);
+                return finish(FetchResult::Unchanged);
+            }
             if (response.status_code() == status_codes::OK) {
-                auto wdata = response.extract_string().get();
-                std::string data = wstring_to_string(wdata);
-                // Save data to file
-                saveToFile(url_to_filename(url), data);
-                Logger::getInstance().log("Downloaded: " + url);
-                return;
+                utility::string_t value;
+                state.etag = response.headers().match(header_names::etag, value) ? utility::conversions::to_utf8string(value) : "";
+                state.lastModified = response.headers().match(header_names::last_modified, value) ? utility::conversions::to_utf8string(value) : "";
+
+                BodyStreambuf buffer(response.body().streambuf(), options.chunkSize);
+                std::istream body(&buffer);
+                consume(body);
+                if (!buffer.error().empty()) {
+                    outcome.error = buffer.error();
+                    Logger::getInstance().log("Download interrupted: " + url + " (" + outcome.error + ")");
+                    return finish(FetchResult::Failed);
+                }
+                state.contentHash = hashToHex(buffer.contentHash());
+                Logger::getInstance().log(LogLevel::Info, "Downloaded: " + url);
+                return finish(FetchResult::Downloaded);
             }
+
+            outcome.error = "HTTP " + std::to_string(outcome.statusCode);
+            retryable = outcome.statusCode == status_codes::RequestTimeout
+                || outcome.statusCode == status_codes::TooManyRequests || outcome.statusCode >= 500;
         }
         catch (const std::exception& e) {
-            Logger::getInstance().log("Attempt " + std::to_string(i + 1) + " failed: " + url);
+            outcome.statusCode = 0;
+            outcome.error = e.what();
         }
+        Logger::getInstance().log(LogLevel::Warning, "Attempt " + std::to_string(i + 1) + " failed: " + url + " (" + outcome.error + ")");
+        if (!retryable) break;
     }
     Logger::getInstance().log("Download failed permanently: " + url);
+    return finish(FetchResult::Failed);
 }
 
-// Parallel downloads using std::async
-void DataDownloader::downloadAllFeedsAsync(const std::vector<std::string>& urls) {
-    std::vector<std::future<void>> futures;
-    for (const auto& url : urls) {
-        futures.push_back(std::async(std::launch::async,
-            &DataDownloader::downloadFeedWithRetry, this, url, 3));
+// Thread-safe download with retries, streaming the body to disk chunk by chunk
+FetchOutcome DataDownloader::downloadFeedWithRetry(const std::string& url, int maxRetries) {
+    FeedState state; // No validators, so the body is always downloaded
+    return saveFeedIfChanged(url, maxRetries, state, url_to_filename(url));
+}
+
+// Conditional download written straight to a binary file. As in
+// fetchFeedIfChanged, a body hashing to the previous content is Unchanged.
+FetchOutcome DataDownloader::saveFeedIfChanged(const std::string& url, int maxRetries, FeedState& state, const std::string& filename) {
+    std::string previousHash = state.contentHash;
+    std::ofstream file;
+    FetchOutcome outcome = streamFeedIfChanged(url, maxRetries, state, [this, &file, &filename](std::istream& body) {
+        file.open(filename, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) return;
+        // Only the writes count as file_write_us; reading the body waits on the network
+        std::vector<char> chunk(std::max<size_t>(options.chunkSize, 1));
+        std::chrono::steady_clock::duration writing(0);
+        for (;;) {
+            body.read(chunk.data(), chunk.size());
+            if (body.gcount() <= 0) break;
+            auto start = std::chrono::steady_clock::now();
+            file.write(chunk.data(), body.gcount());
+            writing += std::chrono::steady_clock::now() - start;
+        }
+        METRICS_RECORD("file_write_us", static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(writing).count()));
+    });
+    if (outcome.result == FetchResult::Downloaded && (!file.is_open() || !file.flush())) {
+        Logger::getInstance().log("Failed to write file: " + filename);
+        outcome.result = FetchResult::Failed;
+        outcome.error = "Failed to write " + filename;
+        METRICS_COUNT("downloads_failed", 1);
+    }
+    else if (outcome.result == FetchResult::Downloaded && !previousHash.empty() && state.contentHash == previousHash) {
+        Logger::getInstance().log(LogLevel::Info, "Unchanged: " + url);
+        outcome.result = FetchResult::Unchanged;
+    }
+    return outcome;
+}
+
+// Parallel downloads on at most maxConcurrent worker threads
+std::vector<FetchOutcome> DataDownloader::downloadAllFeedsAsync(const std::vector<std::string>& urls, int maxRetries) {
+    std::vector<FetchOutcome> outcomes(urls.size());
+    std::atomic<size_t> nextUrl(0);
+    auto worker = [&]() {
+        for (size_t i = nextUrl++; i < urls.size(); i = nextUrl++) {
+            outcomes[i] = downloadFeedWithRetry(urls[i], maxRetries);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    size_t count = std::min(std::max<size_t>(options.maxConcurrent, 1), urls.size());
+    for (size_t i = 0; i < count; ++i) {
+        workers.emplace_back(worker);
     }
     // Wait for all downloads to complete  
-    for (auto& fut : futures) fut.wait();
-}
\ No newline at end of file
+    for (auto& t : workers) t.join();
+    return outcomes;
+}
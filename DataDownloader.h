@@ -1,13 +1,71 @@
 #pragma once  
 #include <cpprest/http_client.h>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <mutex>
 #include <string>  
+#include <unordered_map>
 #include <vector>  
 
+struct FeedState;
+
+// Outcome of a conditional fetch
+enum class FetchResult {
+	Downloaded, // New or changed body
+	Unchanged,  // 304 Not Modified, or the body hashes to the stored content hash
+	Failed
+};
+
+struct DownloadOptions {
+	size_t maxConcurrent = 8;                       // Downloads running at once in downloadAllFeedsAsync
+	std::chrono::milliseconds timeout{ 30000 };     // Per request attempt
+	std::chrono::milliseconds initialBackoff{ 250 }; // Delay before the first retry, doubled for every later one
+	std::chrono::milliseconds maxBackoff{ 8000 };
+	size_t chunkSize = 64 * 1024;                   // Bytes of a streamed body held in memory at once
+};
+
+// What happened to one URL
+struct FetchOutcome {
+	std::string url;
+	FetchResult result = FetchResult::Failed;
+	int attempts = 0;   // 0 if the URL was never tried
+	int statusCode = 0; // Last HTTP status, 0 if no response arrived
+	std::string error;  // Why the last attempt failed
+	std::chrono::milliseconds elapsed{ 0 };
+};
+
+// Reads a streamed response body; runs on the downloading thread
+using BodyConsumer = std::function<void(std::istream& body)>;
+
+// Downloads feeds over one reused http_client per host. Failed attempts are
+// retried after an exponential backoff with jitter; client errors other than
+// 408 and 429 are not retried.
 class DataDownloader {
 public:
 	DataDownloader() = default;
-	void downloadAllFeedsAsync(const std::vector<std::string>& urls);
-	void downloadFeedWithRetry(const std::string& url, int maxRetries);
+	explicit DataDownloader(const DownloadOptions& options) : options(options) {}
+
+	// Saves every feed to disk with at most maxConcurrent downloads at once; outcomes are in URL order
+	std::vector<FetchOutcome> downloadAllFeedsAsync(const std::vector<std::string>& urls, int maxRetries = 3);
+	FetchOutcome downloadFeedWithRetry(const std::string& url, int maxRetries);
+	bool fetchFeed(const std::string& url, int maxRetries, std::string& data);
+	// Sends the validators in state as If-None-Match/If-Modified-Since and
+	// refreshes them from the response; data is only filled when Downloaded
+	FetchOutcome fetchFeedIfChanged(const std::string& url, int maxRetries, FeedState& state, std::string& data);
+	// Same request, but the body is handed to consume as a stream read chunkSize
+	// bytes at a time instead of being buffered; consume is not called for 304s.
+	// Unchanged is only reported for 304s, the content hash is just refreshed.
+	FetchOutcome streamFeedIfChanged(const std::string& url, int maxRetries, FeedState& state, const BodyConsumer& consume);
+	// Same request, with the body streamed to filename in binary
+	FetchOutcome saveFeedIfChanged(const std::string& url, int maxRetries, FeedState& state, const std::string& filename);
+	static std::string contentHash(const std::string& data);
+
+	// Aborts the requests in flight and wakes the backoff waits; every later
+	// request fails straight away, so this is for shutting down
+	void cancel();
 
 	std::string url_to_filename(const std::string& url);
 	std::string loadFile(const std::string& filename);
@@ -15,4 +73,17 @@ public:
 	std::string wstring_to_string(const std::wstring& wstr);
 	std::string getFileExtension(const std::string& filename);
 	std::string extractUniversityName(const std::string& url);
+
+private:
+	std::shared_ptr<web::http::client::http_client> clientFor(const web::uri& uri);
+	std::chrono::milliseconds backoffDelay(int retry);
+	bool waitBackoff(int retry);
+
+	DownloadOptions options;
+	std::mutex clientsMutex;
+	std::unordered_map<std::string, std::shared_ptr<web::http::client::http_client>> clients; // Keyed by scheme://host:port
+	pplx::cancellation_token_source cancellation; // Passed to every request
+	std::mutex cancelMutex;
+	std::condition_variable cancelWake;
+	bool cancelled = false;
 };
\ No newline at end of file
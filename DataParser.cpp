@@ -1,14 +1,366 @@
 #include "DataParser.h"
 #include "Logger.h"
+#include "MappedFile.h"
+#include "Metrics.h"
+#include "XmlPullReader.h"
 #include <rapidjson/document.h>
 #include <rapidjson/error/en.h>
+#include <rapidjson/istreamwrapper.h>
+#include <rapidjson/memorystream.h>
+#include <rapidjson/reader.h>
 #include <tinyxml2.h>
+#include <cctype>
+#include <cstdlib>
+#include <iterator>
 #include <sstream>
 
+namespace {
+
+// Collects candidates and hands them to the sink in fixed-size batches
+class CandidateBatcher {
+public:
+    CandidateBatcher(const CandidateSink& sink, size_t batchSize)
+        : sink(sink), batchSize(batchSize > 0 ? batchSize : 1) {
+        batch.reserve(this->batchSize);
+    }
+
+    void add(Candidate&& candidate) {
+        batch.push_back(std::move(candidate));
+        emitted++;
+        if (batch.size() >= batchSize) flush();
+    }
+
+    void flush() {
+        if (batch.empty()) return;
+        sink(batch);
+        batch.clear();
+    }
+
+    size_t count() const { return emitted; }
+
+private:
+    const CandidateSink& sink;
+    size_t batchSize;
+    size_t emitted = 0;
+    std::vector<Candidate> batch;
+};
+
+// SAX handler that builds one candidate at a time from a top-level JSON array.
+// depth counts the containers currently open: 1 is the feed array, 2 is a
+// candidate object and 3 is the inside of its "skills" array.
+class CandidateHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, CandidateHandler> {
+public:
+    CandidateHandler(const std::string& university, CandidateBatcher& batcher)
+        : university(university), batcher(batcher) {}
+
+    bool StartArray() {
+        if (depth == 2 && field == Field::Skills) {
+            inSkills = true;
+            hasSkills = true;
+        }
+        else if (depth == 2 && field != Field::Other) {
+            invalid = true;
+        }
+        else if (inSkills) {
+            invalid = true;
+        }
+        depth++;
+        return true;
+    }
+
+    bool EndArray(rapidjson::SizeType) {
+        depth--;
+        if (depth == 2) inSkills = false;
+        return true;
+    }
+
+    bool StartObject() {
+        if (depth == 0) {
+            Logger::getInstance().log("JSON parse error: Root is not an array");
+            return false;
+        }
+        if (depth == 1) {
+            current = Candidate();
+            hasName = hasGpa = hasSkills = invalid = false;
+            field = Field::None;
+        }
+        else if ((depth == 2 && field != Field::Other) || inSkills) {
+            invalid = true;
+        }
+        depth++;
+        return true;
+    }
+
+    bool EndObject(rapidjson::SizeType) {
+        depth--;
+        if (depth == 1) finishCandidate();
+        return true;
+    }
+
+    bool Key(const char* str, rapidjson::SizeType length, bool) {
+        if (depth != 2) return true;
+        std::string key(str, length);
+        if (key == "name") field = Field::Name;
+        else if (key == "GPA") field = Field::GPA;
+        else if (key == "skills") field = Field::Skills;
+        else field = Field::Other; // Unknown keys such as "hobby" are skipped
+        return true;
+    }
+
+    bool String(const char* str, rapidjson::SizeType length, bool) {
+        if (depth == 2 && field == Field::Name) {
+            current.name.assign(str, length);
+            hasName = true;
+        }
+        else if (depth == 3 && inSkills) {
+            current.skills.emplace_back(str, length);
+        }
+        else {
+            return Default();
+        }
+        return true;
+    }
+
+    bool Int(int i) { return Number(i); }
+    bool Uint(unsigned u) { return Number(u); }
+    bool Int64(int64_t i) { return Number(static_cast<double>(i)); }
+    bool Uint64(uint64_t u) { return Number(static_cast<double>(u)); }
+    bool Double(double d) { return Number(d); }
+
+    bool Number(double value) {
+        if (depth == 2 && field == Field::GPA) {
+            current.gpa = value;
+            hasGpa = true;
+            return true;
+        }
+        return Default();
+    }
+
+    // Any other scalar: only an error when it lands on a mandatory field
+    bool Default() {
+        if ((depth == 2 && field != Field::Other && field != Field::None) || inSkills) {
+            invalid = true;
+        }
+        return true;
+    }
+
+private:
+    enum class Field { None, Name, GPA, Skills, Other };
+
+    void finishCandidate() {
+        if (!hasName || !hasGpa || !hasSkills) {
+            Logger::getInstance().log(LogLevel::Warning, "Error parsing candidate: Missing mandatory fields");
+            METRICS_COUNT("rows_rejected", 1);
+            return;
+        }
+        if (invalid) {
+            Logger::getInstance().log(LogLevel::Warning, "Error parsing candidate: Invalid mandatory field type");
+            METRICS_COUNT("rows_rejected", 1);
+            return;
+        }
+        current.university = university;
+        batcher.add(std::move(current));
+    }
+
+    const std::string& university;
+    CandidateBatcher& batcher;
+    Candidate current;
+    Field field = Field::None;
+    int depth = 0;
+    bool inSkills = false;
+    bool hasName = false;
+    bool hasGpa = false;
+    bool hasSkills = false;
+    bool invalid = false;
+};
+
+template <typename Stream>
+bool streamJSONCandidates(Stream& stream, const std::string& university, const CandidateSink& sink, size_t batchSize) {
+    METRICS_TIMER("parse_us");
+    CandidateBatcher batcher(sink, batchSize);
+    CandidateHandler handler(university, batcher);
+    rapidjson::Reader reader;
+    rapidjson::ParseResult result = reader.Parse(stream, handler);
+    batcher.flush();
+
+    // Termination means the handler stopped the parse and has logged why
+    if (result.IsError() && result.Code() != rapidjson::kParseErrorTermination) {
+        Logger::getInstance().log("JSON parse error: " + std::string(rapidjson::GetParseError_En(result.Code())));
+        Logger::getInstance().log("Error offset: " + std::to_string(result.Offset()));
+    }
+    METRICS_COUNT("rows_parsed", batcher.count());
+    return !result.IsError();
+}
+
+// Text of the first child element with the given name, or nullptr if it is missing or empty
+const char* childText(tinyxml2::XMLElement* parent, const char* name) {
+    tinyxml2::XMLElement* child = parent->FirstChildElement(name);
+    return child ? child->GetText() : nullptr;
+}
+
+std::string missingFieldsMessage(bool hasName, bool hasGpa, bool hasSkills) {
+    std::string missing;
+    if (!hasName) missing += " <name>";
+    if (!hasGpa) missing += " <GPA>";
+    if (!hasSkills) missing += " <skills>";
+    return "Missing mandatory fields:" + missing;
+}
+
+// Collects the text of a leaf element such as <name>. Child elements inside it
+// are reported as a problem and skipped. Returns false on a syntax error.
+bool readLeafText(XmlPullReader& reader, std::string& text, std::string& problem) {
+    const std::string element = reader.name();
+    const size_t depth = reader.depth();
+    for (;;) {
+        XmlPullReader::Event event = reader.next();
+        if (event == XmlPullReader::Event::Error) return false;
+        if (event == XmlPullReader::Event::Text && reader.depth() == depth) {
+            text += reader.text();
+        }
+        else if (event == XmlPullReader::Event::StartElement && problem.empty()) {
+            problem = "Unexpected <" + reader.name() + "> inside <" + element + ">";
+        }
+        else if (event == XmlPullReader::Event::EndElement && reader.depth() < depth) {
+            return true;
+        }
+    }
+}
+
+// Reads one <candidate> element; the reader is positioned on its start tag.
+// Returns false on a syntax error.
+bool readXMLCandidate(XmlPullReader& reader, size_t index, const std::string& university, CandidateBatcher& batcher) {
+    Candidate c;
+    std::string name;
+    std::string gpa;
+    std::string problem;
+    bool hasName = false;
+    bool hasGpa = false;
+    bool firstSkillHasText = false;
+    bool sawSkills = false;
+    const size_t depth = reader.depth();
+
+    for (;;) {
+        XmlPullReader::Event event = reader.next();
+        if (event == XmlPullReader::Event::Error) return false;
+        if (event == XmlPullReader::Event::EndElement && reader.depth() < depth) break;
+        if (event != XmlPullReader::Event::StartElement) continue;
+
+        std::string text;
+        std::string childProblem;
+        const std::string field = reader.name();
+        if (!readLeafText(reader, text, childProblem)) return false;
+        if (field != "name" && field != "GPA" && field != "skills") {
+            continue; // Unknown children such as <hobby> are ignored
+        }
+        if (problem.empty()) problem = childProblem;
+        if (field == "name" && !hasName) {
+            name = text;
+            hasName = !text.empty();
+        }
+        else if (field == "GPA" && !hasGpa) {
+            gpa = text;
+            hasGpa = !text.empty();
+        }
+        else if (field == "skills") {
+            // Like the DOM path, the first <skills> must have text; empty later ones are skipped
+            if (!sawSkills) firstSkillHasText = !text.empty();
+            sawSkills = true;
+            if (!text.empty()) c.skills.push_back(text);
+        }
+    }
+
+    if (!hasName || !hasGpa || !firstSkillHasText) {
+        problem = missingFieldsMessage(hasName, hasGpa, firstSkillHasText) + (problem.empty() ? "" : "; " + problem);
+    }
+    else if (problem.empty()) {
+        char* parsedEnd = nullptr;
+        c.gpa = std::strtod(gpa.c_str(), &parsedEnd);
+        while (parsedEnd && *parsedEnd && std::isspace(static_cast<unsigned char>(*parsedEnd))) parsedEnd++;
+        if (parsedEnd == gpa.c_str() || (parsedEnd && *parsedEnd)) {
+            problem = "Invalid <GPA> value: " + gpa;
+        }
+    }
+
+    if (!problem.empty()) {
+        Logger::getInstance().log(LogLevel::Warning, "Error parsing candidate " + std::to_string(index) + ": " + problem);
+        METRICS_COUNT("rows_rejected", 1);
+        return true;
+    }
+    c.name = name;
+    c.university = university;
+    batcher.add(std::move(c));
+    return true;
+}
+
+bool streamXMLCandidates(XmlPullReader& reader, const std::string& university, const CandidateSink& sink, size_t batchSize) {
+    METRICS_TIMER("parse_us");
+    CandidateBatcher batcher(sink, batchSize);
+    XmlPullReader::Event event = reader.next();
+    if (event != XmlPullReader::Event::StartElement || reader.name() != "root") {
+        if (event == XmlPullReader::Event::Error) {
+            Logger::getInstance().log("XML parse error: " + reader.error());
+        }
+        else {
+            Logger::getInstance().log("XML parse error: No root node");
+        }
+        return false;
+    }
+
+    size_t index = 0;
+    bool ok = true;
+    while (ok && (event = reader.next()) != XmlPullReader::Event::EndDocument) {
+        if (event == XmlPullReader::Event::Error) {
+            ok = false;
+        }
+        else if (event == XmlPullReader::Event::StartElement && reader.depth() == 2 && reader.name() == "candidate") {
+            ok = readXMLCandidate(reader, ++index, university, batcher);
+        }
+    }
+    batcher.flush();
+
+    if (!ok) {
+        Logger::getInstance().log("XML parse error: " + reader.error());
+    }
+    METRICS_COUNT("rows_parsed", batcher.count());
+    return ok;
+}
+
+}
+
+// Default streaming mode: parse the whole feed, then emit it in batches
+bool Parser::parseStream(const std::string& rawData, const std::string& university, const CandidateSink& sink, size_t batchSize) {
+    CandidateBatcher batcher(sink, batchSize);
+    for (auto& c : parse(rawData, university)) {
+        batcher.add(std::move(c));
+    }
+    batcher.flush();
+    return true;
+}
+
+bool Parser::parseStream(std::istream& input, const std::string& university, const CandidateSink& sink, size_t batchSize) {
+    std::string rawData((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    return parseStream(rawData, university, sink, batchSize);
+}
+
+bool Parser::parseStream(const char* data, size_t size, const std::string& university, const CandidateSink& sink, size_t batchSize) {
+    return parseStream(std::string(data, size), university, sink, batchSize);
+}
+
+bool Parser::parseFile(const std::string& path, const std::string& university, const CandidateSink& sink, size_t batchSize) {
+    MappedFile file;
+    {
+        // Pages are read in on first touch, so that part counts as parse_us
+        METRICS_TIMER("load_file_us");
+        if (!file.open(path)) return false;
+    }
+    return parseStream(file.data(), file.size(), university, sink, batchSize);
+}
+
 // JSON Parser (using RapidJSON)
 std::vector<Candidate> JSONParser::parse(const std::string& rawData, const std::string& university) {
 
-    Logger::getInstance().log("Parsing JSON file: " + university);
+    LOG_DEBUG("Parsing JSON file: " + university);
+    METRICS_TIMER("parse_us");
 
     std::vector<Candidate> candidates;
     rapidjson::Document doc;
@@ -35,16 +387,40 @@ std::vector<Candidate> JSONParser::parse(const std::string& rawData, const std::
             candidates.push_back(c);
         }
         catch (const std::exception& e) {
-            Logger::getInstance().log(std::string("Error parsing candidate: ") + e.what());
+            Logger::getInstance().log(LogLevel::Warning, std::string("Error parsing candidate: ") + e.what());
+            METRICS_COUNT("rows_rejected", 1);
         }
     }
+    METRICS_COUNT("rows_parsed", candidates.size());
     return candidates;
 }
 
+// Streaming JSON Parser (using the RapidJSON SAX Reader)
+bool JSONParser::parseStream(const std::string& rawData, const std::string& university, const CandidateSink& sink, size_t batchSize) {
+    LOG_DEBUG("Streaming JSON data: " + university);
+    rapidjson::StringStream stream(rawData.c_str());
+    return streamJSONCandidates(stream, university, sink, batchSize);
+}
+
+bool JSONParser::parseStream(std::istream& input, const std::string& university, const CandidateSink& sink, size_t batchSize) {
+    LOG_DEBUG("Streaming JSON data: " + university);
+    rapidjson::IStreamWrapper stream(input);
+    return streamJSONCandidates(stream, university, sink, batchSize);
+}
+
+// MemoryStream reads the bytes where they are; only the strings handed to the
+// SAX handler are copied, straight into the candidate
+bool JSONParser::parseStream(const char* data, size_t size, const std::string& university, const CandidateSink& sink, size_t batchSize) {
+    LOG_DEBUG("Streaming JSON data: " + university);
+    rapidjson::MemoryStream stream(data, size);
+    return streamJSONCandidates(stream, university, sink, batchSize);
+}
+
 // XML Parser (using TinyXML-2)
 std::vector<Candidate> XMLParser::parse(const std::string& rawData, const std::string& university) {
     
-	Logger::getInstance().log("Parsing XML file: " + university);
+	LOG_DEBUG("Parsing XML file: " + university);
+    METRICS_TIMER("parse_us");
     
     std::vector<Candidate> candidates;
     tinyxml2::XMLDocument doc;
@@ -62,15 +438,17 @@ std::vector<Candidate> XMLParser::parse(const std::string& rawData, const std::s
         return candidates;
     }
 
+    size_t index = 0;
     for (tinyxml2::XMLElement* node = root->FirstChildElement("candidate"); node; node = node->NextSiblingElement("candidate")) {
+        index++;
         try {
             Candidate c;
-            const char* name = node->FirstChildElement("name")->GetText();
-            const char* gpa = node->FirstChildElement("GPA")->GetText();
-			const char* skills = node->FirstChildElement("skills")->GetText(); // Check for at least one skill
+            const char* name = childText(node, "name");
+            const char* gpa = childText(node, "GPA");
+			const char* skills = childText(node, "skills"); // Check for at least one skill
 
 		    if (!name || !gpa || !skills) {
-				throw std::runtime_error("Missing mandatory fields");
+				throw std::runtime_error(missingFieldsMessage(name != nullptr, gpa != nullptr, skills != nullptr));
 		    }
             c.name = name;
             c.gpa = std::stod(gpa);
@@ -86,12 +464,33 @@ std::vector<Candidate> XMLParser::parse(const std::string& rawData, const std::s
             candidates.push_back(c);
 		}
         catch (const std::exception& e) {
-			Logger::getInstance().log(std::string("Error parsing candidate: ") + e.what());
+			Logger::getInstance().log(LogLevel::Warning, "Error parsing candidate " + std::to_string(index) + ": " + e.what());
+			METRICS_COUNT("rows_rejected", 1);
 		}
     }
+    METRICS_COUNT("rows_parsed", candidates.size());
     return candidates;
 }
 
+// Streaming XML Parser (using XmlPullReader)
+bool XMLParser::parseStream(const std::string& rawData, const std::string& university, const CandidateSink& sink, size_t batchSize) {
+    LOG_DEBUG("Streaming XML data: " + university);
+    XmlPullReader reader(rawData);
+    return streamXMLCandidates(reader, university, sink, batchSize);
+}
+
+bool XMLParser::parseStream(std::istream& input, const std::string& university, const CandidateSink& sink, size_t batchSize) {
+    LOG_DEBUG("Streaming XML data: " + university);
+    XmlPullReader reader(input);
+    return streamXMLCandidates(reader, university, sink, batchSize);
+}
+
+bool XMLParser::parseStream(const char* data, size_t size, const std::string& university, const CandidateSink& sink, size_t batchSize) {
+    LOG_DEBUG("Streaming XML data: " + university);
+    XmlPullReader reader(data, size);
+    return streamXMLCandidates(reader, university, sink, batchSize);
+}
+
 // Parser Factory
 Parser* ParserFactory::createParser(const std::string& fileType) {
     if (fileType == "json") return new JSONParser();
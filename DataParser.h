@@ -1,4 +1,6 @@
 #pragma once
+#include <functional>
+#include <istream>
 #include <string>
 #include <vector>
 
@@ -10,19 +12,50 @@ struct Candidate {
     double score = 0.0f;
 };
 
+// Receives parsed candidates in batches. The batch is cleared after the call,
+// so the sink may move candidates out of it.
+using CandidateSink = std::function<void(std::vector<Candidate>& batch)>;
+
 class Parser {
 public:
+    virtual ~Parser() = default;
     virtual std::vector<Candidate> parse(const std::string& rawData, const std::string& university) = 0;
+
+    // Streaming mode: hands candidates to the sink in batches of at most batchSize.
+    // Returns false if the feed is malformed or ends early, so the caller knows
+    // it only got part of it; rejected candidates alone do not fail the feed.
+    // The default implementations fall back to parse(), which cannot tell, and return true.
+    virtual bool parseStream(const std::string& rawData, const std::string& university, const CandidateSink& sink, size_t batchSize = 256);
+    virtual bool parseStream(std::istream& input, const std::string& university, const CandidateSink& sink, size_t batchSize = 256);
+    // Parses size bytes in place, e.g. a MappedFile; data need not be NUL-terminated
+    virtual bool parseStream(const char* data, size_t size, const std::string& university, const CandidateSink& sink, size_t batchSize = 256);
+
+    // Maps the file and parses it without reading it into memory first; false if
+    // it cannot be mapped or does not parse
+    bool parseFile(const std::string& path, const std::string& university, const CandidateSink& sink, size_t batchSize = 256);
 };
 
 class JSONParser : public Parser {
 public:
     std::vector<Candidate> parse(const std::string& rawData, const std::string& university) override;
+
+    // SAX parsing on top of rapidjson::Reader. Only the current batch is kept in
+    // memory; candidates emitted before a syntax error are not withdrawn.
+    bool parseStream(const std::string& rawData, const std::string& university, const CandidateSink& sink, size_t batchSize = 256) override;
+    bool parseStream(std::istream& input, const std::string& university, const CandidateSink& sink, size_t batchSize = 256) override;
+    bool parseStream(const char* data, size_t size, const std::string& university, const CandidateSink& sink, size_t batchSize = 256) override;
 };
 
 class XMLParser : public Parser {
 public:
     std::vector<Candidate> parse(const std::string& rawData, const std::string& university) override;
+
+    // Pull parsing with XmlPullReader: one <candidate> is held at a time and
+    // malformed or incomplete records are reported and skipped individually.
+    // Candidates emitted before a syntax error are not withdrawn.
+    bool parseStream(const std::string& rawData, const std::string& university, const CandidateSink& sink, size_t batchSize = 256) override;
+    bool parseStream(std::istream& input, const std::string& university, const CandidateSink& sink, size_t batchSize = 256) override;
+    bool parseStream(const char* data, size_t size, const std::string& university, const CandidateSink& sink, size_t batchSize = 256) override;
 };
 
 class ParserFactory {
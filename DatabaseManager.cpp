@@ -1,11 +1,17 @@
 #include "DatabaseManager.h"  
 #include "Logger.h"  
+#include "Metrics.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <functional>
 #include <mutex>  
 #include <iostream>
 #include <sstream>
 
-// Mutex for thread-safe database access  
-static std::mutex dbMutex;
+// Held by every public member: the ingest writer and the GUI share one
+// connection and its cached statements. Recursive, as members call each other.
+static std::recursive_mutex dbMutex;
 
 DatabaseManager* DatabaseManager::instance = nullptr;
 
@@ -16,22 +22,42 @@ DatabaseManager& DatabaseManager::getInstance() {
     return *instance;
 }
 
+#if METRICS_ENABLED
+// Called by SQLite as each statement starts running, including trigger bodies
+static int countStatement(unsigned, void*, void*, void*) {
+    METRICS_COUNT("sql_statements", 1);
+    return 0;
+}
+#endif
+
 bool DatabaseManager::open(const std::string& dbPath) {
+    std::lock_guard<std::recursive_mutex> lock(dbMutex);
     if (sqlite3_open(dbPath.c_str(), &db) != SQLITE_OK) {
         Logger::getInstance().log("Failed to open database: " + std::string(sqlite3_errmsg(db)));
         return false;
     }
+#if METRICS_ENABLED
+    sqlite3_trace_v2(db, SQLITE_TRACE_STMT, countStatement, nullptr);
+#endif
     return true;
 }
 
 void DatabaseManager::close() {
+    std::lock_guard<std::recursive_mutex> lock(dbMutex);
     if (db) {
+        finalizeStatements();
         sqlite3_close(db);
         db = nullptr;
     }
 }
 
 bool DatabaseManager::createTables() {
+    std::lock_guard<std::recursive_mutex> lock(dbMutex);
+    // Skills live in a dictionary table linked through candidate_skills; the
+    // legacy comma-joined candidates.skills column is only read by the migration.
+    // The *_summary tables hold per-date stats kept up to date by every insert.
+    // feed_state remembers the validators of the last inserted download per feed.
+    // The unique (download_date, university, name) key is added by the migration.
     const char* sql = R"(
         CREATE TABLE IF NOT EXISTS candidates (
             id INTEGER PRIMARY KEY AUTOINCREMENT,
@@ -39,8 +65,41 @@ bool DatabaseManager::createTables() {
             gpa REAL CHECK (gpa BETWEEN 0 AND 4),
             university TEXT NOT NULL,
             skills TEXT,
-            download_date TEXT NOT NULL
+            download_date TEXT NOT NULL,
+            row_hash INTEGER
+        );
+        CREATE TABLE IF NOT EXISTS skills (
+            id INTEGER PRIMARY KEY,
+            name TEXT NOT NULL UNIQUE
         );
+        CREATE TABLE IF NOT EXISTS candidate_skills (
+            candidate_id INTEGER NOT NULL REFERENCES candidates(id) ON DELETE CASCADE,
+            position INTEGER NOT NULL,
+            skill_id INTEGER NOT NULL REFERENCES skills(id),
+            PRIMARY KEY (candidate_id, position)
+        ) WITHOUT ROWID;
+        CREATE INDEX IF NOT EXISTS idx_candidate_skills_skill ON candidate_skills(skill_id, candidate_id);
+        CREATE INDEX IF NOT EXISTS idx_candidates_date_gpa ON candidates(download_date, gpa);
+        CREATE TABLE IF NOT EXISTS university_summary (
+            download_date TEXT NOT NULL,
+            university TEXT NOT NULL,
+            candidates INTEGER NOT NULL,
+            gpa_sum REAL NOT NULL,
+            PRIMARY KEY (download_date, university)
+        ) WITHOUT ROWID;
+        CREATE TABLE IF NOT EXISTS skill_summary (
+            download_date TEXT NOT NULL,
+            skill_id INTEGER NOT NULL REFERENCES skills(id),
+            candidates INTEGER NOT NULL,
+            PRIMARY KEY (download_date, skill_id)
+        ) WITHOUT ROWID;
+        CREATE TABLE IF NOT EXISTS feed_state (
+            url TEXT PRIMARY KEY,
+            etag TEXT NOT NULL,
+            last_modified TEXT NOT NULL,
+            content_hash TEXT NOT NULL,
+            download_date TEXT NOT NULL
+        ) WITHOUT ROWID;
     )";
     char* errMsg = nullptr;
     if (sqlite3_exec(db, sql, nullptr, nullptr, &errMsg) != SQLITE_OK) {
@@ -48,81 +107,614 @@ bool DatabaseManager::createTables() {
         sqlite3_free(errMsg);
         return false;
     }
+    return migrateSchema();
+}
+
+// Schema versions are tracked in PRAGMA user_version:
+// 0 = skills stored as comma-joined text, 1 = normalized skills tables,
+// 2 = summary tables, 3 = unique key per candidate and date
+bool DatabaseManager::migrateSchema() {
+    std::lock_guard<std::recursive_mutex> lock(dbMutex);
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db, "PRAGMA user_version;", -1, &stmt, nullptr) != SQLITE_OK) {
+        Logger::getInstance().log("Failed to read schema version: " + std::string(sqlite3_errmsg(db)));
+        return false;
+    }
+    int version = sqlite3_step(stmt) == SQLITE_ROW ? sqlite3_column_int(stmt, 0) : 0;
+    sqlite3_finalize(stmt);
+
+    // The insert statements upsert on the candidate key, so it has to exist before any of them is prepared
+    if (version < 3) {
+        Logger::getInstance().log(LogLevel::Info, "Removing duplicate candidates and adding the candidate key");
+        if (!migrateDedupKey()) return false;
+    }
+
+    if (version < 1) {
+        Logger::getInstance().log(LogLevel::Info, "Migrating candidate skills to the normalized schema");
+        if (!beginTransaction()) return false;
+        if (!migrateLegacySkills() || sqlite3_exec(db, "PRAGMA user_version = 1;", nullptr, nullptr, nullptr) != SQLITE_OK) {
+            Logger::getInstance().log("Failed to migrate skills: " + std::string(sqlite3_errmsg(db)));
+            sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+            skillIds.clear();
+            return false;
+        }
+        if (!commitTransaction()) return false;
+    }
+
+    if (version < 2) {
+        Logger::getInstance().log(LogLevel::Info, "Building summary tables");
+        if (!rebuildSummaries() || sqlite3_exec(db, "PRAGMA user_version = 2;", nullptr, nullptr, nullptr) != SQLITE_OK) {
+            return false;
+        }
+    }
+
+    if (version < 3) {
+        // Version 2 summaries still count the removed duplicates
+        if ((version == 2 && !rebuildSummaries()) || sqlite3_exec(db, "PRAGMA user_version = 3;", nullptr, nullptr, nullptr) != SQLITE_OK) {
+            return false;
+        }
+    }
     return true;
 }
 
-bool DatabaseManager::insertCandidate(const Candidate& candidate, const std::string& downloadDate) {
-    Logger::getInstance().log("Inserting candidate: " + candidate.name);
-    
-    // Serialize skills into a comma-separated string
-    std::stringstream skillsStream;
-    for (size_t i = 0; i < candidate.skills.size(); ++i) {
-        skillsStream << candidate.skills[i];
-        if (i < candidate.skills.size() - 1) skillsStream << ",";
-    }
-    std::string skillsStr = skillsStream.str();
-
-    // Prepare SQL statement
-    const char* sql = "INSERT INTO candidates (name, gpa, university, skills, download_date) VALUES (?, ?, ?, ?, ?);";
+// Keeps the newest row of every (download_date, university, name) and makes
+// that the unique key. Safe to rerun if a later step fails.
+bool DatabaseManager::migrateDedupKey() {
     sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
-        Logger::getInstance().log("Failed to prepare insert statement: " + std::string(sqlite3_errmsg(db)));
+    if (sqlite3_prepare_v2(db, "SELECT COUNT(*) FROM pragma_table_info('candidates') WHERE name = 'row_hash';", -1, &stmt, nullptr) != SQLITE_OK) {
         return false;
     }
+    bool hasHash = sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_int(stmt, 0) > 0;
+    sqlite3_finalize(stmt);
 
-    // Bind parameters
-    sqlite3_bind_text(stmt, 1, candidate.name.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_double(stmt, 2, candidate.gpa);
-    sqlite3_bind_text(stmt, 3, candidate.university.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 4, skillsStr.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 5, downloadDate.c_str(), -1, SQLITE_STATIC);
+    // Rows from before the migration have no hash, so their next ingest rewrites them once
+    std::string sql = hasHash ? "" : "ALTER TABLE candidates ADD COLUMN row_hash INTEGER;";
+    sql += R"(
+        CREATE TEMP TABLE stale_candidates AS
+            SELECT id FROM candidates
+            WHERE id NOT IN (SELECT MAX(id) FROM candidates GROUP BY download_date, university, name);
+        DELETE FROM candidate_skills WHERE candidate_id IN (SELECT id FROM stale_candidates);
+        DELETE FROM candidates WHERE id IN (SELECT id FROM stale_candidates);
+        DROP TABLE stale_candidates;
+        DROP INDEX IF EXISTS idx_candidates_date_university;
+        CREATE UNIQUE INDEX IF NOT EXISTS idx_candidates_key ON candidates(download_date, university, name);
+    )";
+    if (!beginTransaction()) return false;
+    char* errMsg = nullptr;
+    if (sqlite3_exec(db, sql.c_str(), nullptr, nullptr, &errMsg) != SQLITE_OK) {
+        Logger::getInstance().log("Failed to add the candidate key: " + std::string(errMsg));
+        sqlite3_free(errMsg);
+        sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+        return false;
+    }
+    return commitTransaction();
+}
 
-    // Execute
-    if (sqlite3_step(stmt) != SQLITE_DONE) {
-        Logger::getInstance().log("Failed to insert candidate: " + std::string(sqlite3_errmsg(db)));
-        sqlite3_finalize(stmt);
+// Moves the comma-joined skills of existing rows into candidate_skills
+bool DatabaseManager::migrateLegacySkills() {
+    if (!prepareInsertStatements()) return false;
+
+    sqlite3_stmt* stmt;
+    const char* sql = "SELECT id, skills FROM candidates WHERE skills IS NOT NULL AND skills <> '';";
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
         return false;
     }
 
+    bool ok = true;
+    int rc;
+    while (ok && (rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        std::vector<std::string> skills;
+        std::stringstream ss(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)));
+        std::string skill;
+        while (std::getline(ss, skill, ',')) {
+            skills.push_back(skill);
+        }
+        ok = insertSkills(sqlite3_column_int64(stmt, 0), skills);
+    }
     sqlite3_finalize(stmt);
+
+    return ok && sqlite3_exec(db, "UPDATE candidates SET skills = NULL WHERE skills IS NOT NULL;", nullptr, nullptr, nullptr) == SQLITE_OK;
+}
+
+static const int insertColumns = 5;
+
+// 64-bit FNV-1a over the columns outside the key, so unchanged rows can be told apart cheaply
+static sqlite3_int64 rowHash(const Candidate& candidate) {
+    uint64_t hash = 14695981039346656037ULL;
+    auto mix = [&hash](const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+    };
+    mix(&candidate.gpa, sizeof(candidate.gpa));
+    for (const auto& skill : candidate.skills) {
+        mix(skill.c_str(), skill.size() + 1); // Include the terminator as a separator
+    }
+    return static_cast<sqlite3_int64>(hash);
+}
+
+bool DatabaseManager::prepareInsertStatements() {
+    if (!db) return false;
+
+    struct Statement {
+        sqlite3_stmt** stmt;
+        const char* sql;
+    };
+    const Statement statements[] = {
+        { &insertStmt, "INSERT INTO candidates (name, gpa, university, download_date, row_hash) VALUES (?, ?, ?, ?, ?) "
+            "ON CONFLICT (download_date, university, name) DO UPDATE SET gpa = excluded.gpa, row_hash = excluded.row_hash "
+            "WHERE row_hash IS NOT excluded.row_hash;" },
+        { &findStmt, "SELECT id, gpa, row_hash FROM candidates WHERE download_date = ? AND university = ? AND name = ?;" },
+        { &selectCandidateSkillsStmt, "SELECT skill_id FROM candidate_skills WHERE candidate_id = ?;" },
+        { &deleteCandidateSkillsStmt, "DELETE FROM candidate_skills WHERE candidate_id = ?;" },
+        { &selectSkillStmt, "SELECT id FROM skills WHERE name = ?;" },
+        { &insertSkillStmt, "INSERT INTO skills (name) VALUES (?);" },
+        { &insertCandidateSkillStmt, "INSERT INTO candidate_skills (candidate_id, position, skill_id) VALUES (?, ?, ?);" },
+        { &savepointStmt, "SAVEPOINT row_write;" },
+        { &releaseStmt, "RELEASE row_write;" },
+        { &rollbackToStmt, "ROLLBACK TO row_write;" },
+    };
+    for (const auto& statement : statements) {
+        if (*statement.stmt) continue;
+        if (sqlite3_prepare_v2(db, statement.sql, -1, statement.stmt, nullptr) != SQLITE_OK) {
+            Logger::getInstance().log("Failed to prepare insert statement: " + std::string(sqlite3_errmsg(db)));
+            *statement.stmt = nullptr;
+            return false;
+        }
+    }
+
+    // Keep the multi-row statement under the host parameter limit
+    size_t maxRows = static_cast<size_t>(sqlite3_limit(db, SQLITE_LIMIT_VARIABLE_NUMBER, -1)) / insertColumns;
+    if (rowsPerStatement > maxRows) rowsPerStatement = maxRows;
+    if (!insertManyStmt && rowsPerStatement > 1) {
+        std::string sql = "INSERT INTO candidates (name, gpa, university, download_date, row_hash) VALUES ";
+        for (size_t i = 0; i < rowsPerStatement; ++i) {
+            sql += (i == 0) ? "(?, ?, ?, ?, ?)" : ", (?, ?, ?, ?, ?)";
+        }
+        sql += ";";
+        if (sqlite3_prepare_v2(db, sql.c_str(), -1, &insertManyStmt, nullptr) != SQLITE_OK) {
+            Logger::getInstance().log("Failed to prepare multi-row insert statement: " + std::string(sqlite3_errmsg(db)));
+            insertManyStmt = nullptr; // Fall back to single-row inserts
+        }
+    }
     return true;
 }
 
-std::vector<Candidate> DatabaseManager::getCandidatesByDate(const std::string& date) {
+void DatabaseManager::finalizeStatements() {
+    for (sqlite3_stmt** stmt : { &insertStmt, &insertManyStmt, &findStmt, &selectCandidateSkillsStmt, &deleteCandidateSkillsStmt,
+        &selectSkillStmt, &insertSkillStmt, &insertCandidateSkillStmt, &savepointStmt, &releaseStmt, &rollbackToStmt }) {
+        sqlite3_finalize(*stmt);
+        *stmt = nullptr;
+    }
+    skillIds.clear();
+}
+
+bool DatabaseManager::bindCandidate(sqlite3_stmt* stmt, int firstParam, const Candidate& candidate, const std::string& downloadDate) {
+    return sqlite3_bind_text(stmt, firstParam, candidate.name.c_str(), -1, SQLITE_STATIC) == SQLITE_OK
+        && sqlite3_bind_double(stmt, firstParam + 1, candidate.gpa) == SQLITE_OK
+        && sqlite3_bind_text(stmt, firstParam + 2, candidate.university.c_str(), -1, SQLITE_STATIC) == SQLITE_OK
+        && sqlite3_bind_text(stmt, firstParam + 3, downloadDate.c_str(), -1, SQLITE_STATIC) == SQLITE_OK
+        && sqlite3_bind_int64(stmt, firstParam + 4, rowHash(candidate)) == SQLITE_OK;
+}
+
+// Resolves a skill name to its dictionary id, optionally adding it
+bool DatabaseManager::lookupSkillId(const std::string& skill, bool create, sqlite3_int64& id) {
+    auto it = skillIds.find(skill);
+    if (it != skillIds.end()) {
+        id = it->second;
+        return true;
+    }
+
+    sqlite3_bind_text(selectSkillStmt, 1, skill.c_str(), -1, SQLITE_STATIC);
+    bool found = sqlite3_step(selectSkillStmt) == SQLITE_ROW;
+    if (found) id = sqlite3_column_int64(selectSkillStmt, 0);
+    sqlite3_reset(selectSkillStmt);
+
+    if (!found && create) {
+        sqlite3_bind_text(insertSkillStmt, 1, skill.c_str(), -1, SQLITE_STATIC);
+        found = sqlite3_step(insertSkillStmt) == SQLITE_DONE;
+        sqlite3_reset(insertSkillStmt);
+        if (found) id = sqlite3_last_insert_rowid(db);
+        if (found && savepointOpen) savepointSkills.push_back(skill);
+    }
+    if (found) skillIds[skill] = id;
+    return found;
+}
+
+bool DatabaseManager::insertSkills(sqlite3_int64 candidateId, const std::vector<std::string>& skills) {
+    for (size_t i = 0; i < skills.size(); ++i) {
+        sqlite3_int64 skillId;
+        if (!lookupSkillId(skills[i], true, skillId)) return false;
+        sqlite3_bind_int64(insertCandidateSkillStmt, 1, candidateId);
+        sqlite3_bind_int64(insertCandidateSkillStmt, 2, static_cast<sqlite3_int64>(i));
+        sqlite3_bind_int64(insertCandidateSkillStmt, 3, skillId);
+        bool ok = sqlite3_step(insertCandidateSkillStmt) == SQLITE_DONE;
+        sqlite3_reset(insertCandidateSkillStmt);
+        if (!ok) {
+            Logger::getInstance().log("Failed to insert candidate skill: " + std::string(sqlite3_errmsg(db)));
+            return false;
+        }
+    }
+    return true;
+}
+
+void DatabaseManager::addToSummary(SummaryDelta& delta, const Candidate& candidate) {
+    UniversitySummary& university = delta.universities[candidate.university];
+    university.candidates++;
+    university.gpaSum += candidate.gpa;
+    for (const auto& skill : candidate.skills) {
+        sqlite3_int64 id;
+        if (lookupSkillId(skill, false, id)) delta.skills[id]++;
+    }
+}
+
+// Adds the delta to the summary tables; runs inside the caller's transaction
+bool DatabaseManager::applySummary(const SummaryDelta& delta, const std::string& date) {
+    const char* universitySql = R"(
+        INSERT INTO university_summary (download_date, university, candidates, gpa_sum) VALUES (?, ?, ?, ?)
+        ON CONFLICT (download_date, university) DO UPDATE SET
+            candidates = candidates + excluded.candidates, gpa_sum = gpa_sum + excluded.gpa_sum;
+    )";
+    const char* skillSql = R"(
+        INSERT INTO skill_summary (download_date, skill_id, candidates) VALUES (?, ?, ?)
+        ON CONFLICT (download_date, skill_id) DO UPDATE SET candidates = candidates + excluded.candidates;
+    )";
+    sqlite3_stmt* universityStmt = nullptr;
+    sqlite3_stmt* skillStmt = nullptr;
+    bool ok = sqlite3_prepare_v2(db, universitySql, -1, &universityStmt, nullptr) == SQLITE_OK
+        && sqlite3_prepare_v2(db, skillSql, -1, &skillStmt, nullptr) == SQLITE_OK;
+
+    for (auto it = delta.universities.begin(); ok && it != delta.universities.end(); ++it) {
+        sqlite3_bind_text(universityStmt, 1, date.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(universityStmt, 2, it->first.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_int(universityStmt, 3, it->second.candidates);
+        sqlite3_bind_double(universityStmt, 4, it->second.gpaSum);
+        ok = sqlite3_step(universityStmt) == SQLITE_DONE;
+        sqlite3_reset(universityStmt);
+    }
+    for (auto it = delta.skills.begin(); ok && it != delta.skills.end(); ++it) {
+        sqlite3_bind_text(skillStmt, 1, date.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_int64(skillStmt, 2, it->first);
+        sqlite3_bind_int(skillStmt, 3, it->second);
+        ok = sqlite3_step(skillStmt) == SQLITE_DONE;
+        sqlite3_reset(skillStmt);
+    }
+    if (!ok) {
+        Logger::getInstance().log("Failed to update summary tables: " + std::string(sqlite3_errmsg(db)));
+    }
+    sqlite3_finalize(universityStmt);
+    sqlite3_finalize(skillStmt);
+    return ok;
+}
+
+// Recomputes both summary tables from the candidate data, in case they drift
+bool DatabaseManager::rebuildSummaries() {
+    std::lock_guard<std::recursive_mutex> lock(dbMutex);
+    const char* sql = R"(
+        DELETE FROM university_summary;
+        DELETE FROM skill_summary;
+        INSERT INTO university_summary (download_date, university, candidates, gpa_sum)
+            SELECT download_date, university, COUNT(*), TOTAL(gpa)
+            FROM candidates
+            GROUP BY download_date, university;
+        INSERT INTO skill_summary (download_date, skill_id, candidates)
+            SELECT c.download_date, cs.skill_id, COUNT(*)
+            FROM candidate_skills cs
+            JOIN candidates c ON c.id = cs.candidate_id
+            GROUP BY c.download_date, cs.skill_id;
+    )";
+    if (!beginTransaction()) return false;
+    char* errMsg = nullptr;
+    if (sqlite3_exec(db, sql, nullptr, nullptr, &errMsg) != SQLITE_OK) {
+        Logger::getInstance().log("Failed to rebuild summary tables: " + std::string(errMsg));
+        sqlite3_free(errMsg);
+        sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+        return false;
+    }
+    return commitTransaction();
+}
+
+// Savepoint around the writes of one row inside the open transaction, so a
+// row that fails halfway leaves nothing behind
+bool DatabaseManager::openSavepoint() {
+    savepointOpen = sqlite3_step(savepointStmt) == SQLITE_DONE;
+    sqlite3_reset(savepointStmt);
+    savepointSkills.clear();
+    return savepointOpen;
+}
+
+void DatabaseManager::closeSavepoint(bool keep) {
+    if (!keep) {
+        sqlite3_step(rollbackToStmt);
+        sqlite3_reset(rollbackToStmt);
+        // Only the skills added since the savepoint are gone; the rest of the cache stays valid
+        for (const auto& skill : savepointSkills) {
+            skillIds.erase(skill);
+        }
+    }
+    sqlite3_step(releaseStmt);
+    sqlite3_reset(releaseStmt);
+    savepointSkills.clear();
+    savepointOpen = false;
+}
+
+// Id of the row stored under the candidate's key, 0 if there is none
+sqlite3_int64 DatabaseManager::findId(const Candidate& candidate, const std::string& downloadDate) {
+    sqlite3_bind_text(findStmt, 1, downloadDate.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(findStmt, 2, candidate.university.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(findStmt, 3, candidate.name.c_str(), -1, SQLITE_STATIC);
+    sqlite3_int64 id = sqlite3_step(findStmt) == SQLITE_ROW ? sqlite3_column_int64(findStmt, 0) : 0;
+    sqlite3_reset(findStmt);
+    return id;
+}
+
+// Upserts one candidate on its (download_date, university, name) key. A row
+// with the same content is left untouched; a changed row is rewritten in place
+// and its old values are taken out of the summary.
+DatabaseManager::RowOutcome DatabaseManager::upsertRow(const Candidate& candidate, const std::string& downloadDate, SummaryDelta& delta) {
+    sqlite3_bind_text(findStmt, 1, downloadDate.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(findStmt, 2, candidate.university.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(findStmt, 3, candidate.name.c_str(), -1, SQLITE_STATIC);
+    bool exists = sqlite3_step(findStmt) == SQLITE_ROW;
+    sqlite3_int64 id = exists ? sqlite3_column_int64(findStmt, 0) : 0;
+    double oldGpa = exists ? sqlite3_column_double(findStmt, 1) : 0.0;
+    bool same = exists && sqlite3_column_type(findStmt, 2) != SQLITE_NULL && sqlite3_column_int64(findStmt, 2) == rowHash(candidate);
+    sqlite3_reset(findStmt);
+    if (same) return RowOutcome::Duplicate;
+
+    std::vector<sqlite3_int64> oldSkills;
+    if (exists) {
+        sqlite3_bind_int64(selectCandidateSkillsStmt, 1, id);
+        while (sqlite3_step(selectCandidateSkillsStmt) == SQLITE_ROW) {
+            oldSkills.push_back(sqlite3_column_int64(selectCandidateSkillsStmt, 0));
+        }
+        sqlite3_reset(selectCandidateSkillsStmt);
+    }
+
+    if (!openSavepoint()) return RowOutcome::Failed;
+    bool ok = bindCandidate(insertStmt, 1, candidate, downloadDate) && sqlite3_step(insertStmt) == SQLITE_DONE;
+    sqlite3_reset(insertStmt);
+    sqlite3_clear_bindings(insertStmt);
+    if (ok && exists) {
+        sqlite3_bind_int64(deleteCandidateSkillsStmt, 1, id);
+        ok = sqlite3_step(deleteCandidateSkillsStmt) == SQLITE_DONE;
+        sqlite3_reset(deleteCandidateSkillsStmt);
+    }
+    ok = ok && insertSkills(exists ? id : sqlite3_last_insert_rowid(db), candidate.skills);
+    closeSavepoint(ok);
+    if (!ok) return RowOutcome::Failed;
+
+    if (exists) {
+        UniversitySummary& university = delta.universities[candidate.university];
+        university.candidates--;
+        university.gpaSum -= oldGpa;
+        for (sqlite3_int64 skillId : oldSkills) delta.skills[skillId]--;
+    }
+    addToSummary(delta, candidate);
+    return exists ? RowOutcome::Updated : RowOutcome::Inserted;
+}
+
+bool DatabaseManager::insertCandidate(const Candidate& candidate, const std::string& downloadDate) {
+    std::lock_guard<std::recursive_mutex> lock(dbMutex);
+    METRICS_TIMER("insert_us");
+    if (!prepareInsertStatements() || !beginTransaction()) return false;
+    SummaryDelta delta;
+    bool ok = upsertRow(candidate, downloadDate, delta) != RowOutcome::Failed && applySummary(delta, downloadDate);
+    if (!ok || !commitTransaction()) {
+        sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+        skillIds.clear();
+        return false;
+    }
+    return true;
+}
+
+// Reads rows shaped (id, name, gpa, university, skill) ordered by id, one row per skill
+std::vector<Candidate> DatabaseManager::readCandidates(sqlite3_stmt* stmt) {
     std::vector<Candidate> candidates;
-    const char* sql = "SELECT name, gpa, university, skills FROM candidates WHERE download_date = ?;";
+    sqlite3_int64 currentId = 0;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        sqlite3_int64 id = sqlite3_column_int64(stmt, 0);
+        if (candidates.empty() || id != currentId) {
+            Candidate c;
+            c.name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+            c.gpa = sqlite3_column_double(stmt, 2);
+            c.university = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
+            candidates.push_back(std::move(c));
+            currentId = id;
+        }
+        if (sqlite3_column_type(stmt, 4) != SQLITE_NULL) {
+            candidates.back().skills.emplace_back(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 4)));
+        }
+    }
+    return candidates;
+}
+
+std::vector<Candidate> DatabaseManager::getCandidatesByDate(const std::string& date) {
+    std::lock_guard<std::recursive_mutex> lock(dbMutex);
+    METRICS_TIMER("query_by_date_us");
+    const char* sql = R"(
+        SELECT c.id, c.name, c.gpa, c.university, s.name
+        FROM candidates c
+        LEFT JOIN candidate_skills cs ON cs.candidate_id = c.id
+        LEFT JOIN skills s ON s.id = cs.skill_id
+        WHERE c.download_date = ?
+        ORDER BY c.id, cs.position;
+    )";
     sqlite3_stmt* stmt;
 
     if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
         Logger::getInstance().log("Failed to prepare query: " + std::string(sqlite3_errmsg(db)));
-        return candidates;
+        return {};
     }
 
     sqlite3_bind_text(stmt, 1, date.c_str(), -1, SQLITE_STATIC);
+    std::vector<Candidate> candidates = readCandidates(stmt);
+    sqlite3_finalize(stmt);
+    return candidates;
+}
 
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
-        Candidate c;
-        c.name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
-        c.gpa = sqlite3_column_double(stmt, 1);
-        c.university = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
-
-        // Deserialize skills
-        std::string skillsStr = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
-        std::stringstream ss(skillsStr);
-        std::string skill;
-        while (std::getline(ss, skill, ',')) {
-            c.skills.push_back(skill);
+// Compiles the checked criteria of a FilterData into one parameterized query,
+// so only matching rows leave SQLite. The date, university and GPA predicates
+// are served by the (download_date, ...) indexes and skills are matched on ids.
+std::vector<Candidate> DatabaseManager::queryCandidates(const FilterData& filter) {
+    std::lock_guard<std::recursive_mutex> lock(dbMutex);
+    METRICS_TIMER("filter_us");
+    std::string where = "c.download_date = ?";
+    std::vector<std::function<int(sqlite3_stmt*, int)>> binders;
+    binders.push_back([&filter](sqlite3_stmt* stmt, int index) { return sqlite3_bind_text(stmt, index, filter.date.c_str(), -1, SQLITE_STATIC); });
+
+    if (filter.universityChecked) {
+        where += " AND c.university = ?";
+        binders.push_back([&filter](sqlite3_stmt* stmt, int index) { return sqlite3_bind_text(stmt, index, filter.university.c_str(), -1, SQLITE_STATIC); });
+    }
+
+    if (filter.gpaChecked) {
+        where += " AND c.gpa BETWEEN ? AND ?";
+        binders.push_back([&filter](sqlite3_stmt* stmt, int index) { return sqlite3_bind_double(stmt, index, filter.minGPA); });
+        binders.push_back([&filter](sqlite3_stmt* stmt, int index) { return sqlite3_bind_double(stmt, index, filter.maxGPA); });
+    }
+
+    std::vector<sqlite3_int64> skillIdList;
+    if (filter.skillsChecked && !filter.skills.empty()) {
+        if (!prepareInsertStatements()) return {};
+        for (const auto& skill : filter.skills) {
+            sqlite3_int64 id;
+            if (!lookupSkillId(skill, false, id)) return {}; // Unknown skill: nobody can match
+            if (std::find(skillIdList.begin(), skillIdList.end(), id) == skillIdList.end()) skillIdList.push_back(id);
         }
 
-        candidates.push_back(c);
+        where += " AND c.id IN (SELECT candidate_id FROM candidate_skills WHERE skill_id IN (";
+        for (size_t i = 0; i < skillIdList.size(); ++i) {
+            where += (i == 0) ? "?" : ", ?";
+            sqlite3_int64 id = skillIdList[i];
+            binders.push_back([id](sqlite3_stmt* stmt, int index) { return sqlite3_bind_int64(stmt, index, id); });
+        }
+        where += ") GROUP BY candidate_id HAVING COUNT(DISTINCT skill_id) = ?)";
+        int required = static_cast<int>(skillIdList.size());
+        binders.push_back([required](sqlite3_stmt* stmt, int index) { return sqlite3_bind_int(stmt, index, required); });
     }
 
+    std::string sql = R"(
+        SELECT c.id, c.name, c.gpa, c.university, s.name
+        FROM candidates c
+        LEFT JOIN candidate_skills cs ON cs.candidate_id = c.id
+        LEFT JOIN skills s ON s.id = cs.skill_id
+        WHERE )" + where + R"(
+        ORDER BY c.id, cs.position;
+    )";
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+        Logger::getInstance().log("Failed to prepare query: " + std::string(sqlite3_errmsg(db)));
+        return {};
+    }
+    for (size_t i = 0; i < binders.size(); ++i) {
+        binders[i](stmt, static_cast<int>(i + 1));
+    }
+
+    std::vector<Candidate> candidates = readCandidates(stmt);
     sqlite3_finalize(stmt);
     return candidates;
 }
 
+// Skill frequencies for a date, most frequent first, read from skill_summary
+std::vector<std::pair<std::string, int>> DatabaseManager::getSkillCounts(const std::string& date) {
+    std::lock_guard<std::recursive_mutex> lock(dbMutex);
+    std::vector<std::pair<std::string, int>> counts;
+    const char* sql = R"(
+        SELECT s.name, ss.candidates
+        FROM skill_summary ss
+        JOIN skills s ON s.id = ss.skill_id
+        WHERE ss.download_date = ? AND ss.candidates > 0
+        ORDER BY ss.candidates DESC, s.name;
+    )";
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        Logger::getInstance().log("Failed to prepare query: " + std::string(sqlite3_errmsg(db)));
+        return counts;
+    }
+
+    sqlite3_bind_text(stmt, 1, date.c_str(), -1, SQLITE_STATIC);
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        counts.emplace_back(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0)), sqlite3_column_int(stmt, 1));
+    }
+    sqlite3_finalize(stmt);
+    return counts;
+}
+
+// Candidates and GPA sum per university for a date, read from university_summary
+std::vector<UniversitySummary> DatabaseManager::getUniversitySummary(const std::string& date) {
+    std::lock_guard<std::recursive_mutex> lock(dbMutex);
+    std::vector<UniversitySummary> summary;
+    const char* sql = "SELECT university, candidates, gpa_sum FROM university_summary WHERE download_date = ? AND candidates > 0 ORDER BY university;";
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        Logger::getInstance().log("Failed to prepare query: " + std::string(sqlite3_errmsg(db)));
+        return summary;
+    }
+
+    sqlite3_bind_text(stmt, 1, date.c_str(), -1, SQLITE_STATIC);
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        UniversitySummary row;
+        row.university = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+        row.candidates = sqlite3_column_int(stmt, 1);
+        row.gpaSum = sqlite3_column_double(stmt, 2);
+        summary.push_back(std::move(row));
+    }
+    sqlite3_finalize(stmt);
+    return summary;
+}
+
+// Validators of every feed, keyed by URL
+std::unordered_map<std::string, FeedState> DatabaseManager::getFeedStates() {
+    std::lock_guard<std::recursive_mutex> lock(dbMutex);
+    std::unordered_map<std::string, FeedState> states;
+    const char* sql = "SELECT url, etag, last_modified, content_hash, download_date FROM feed_state;";
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        Logger::getInstance().log("Failed to prepare query: " + std::string(sqlite3_errmsg(db)));
+        return states;
+    }
+
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        FeedState& state = states[reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0))];
+        state.etag = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+        state.lastModified = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
+        state.contentHash = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
+        state.downloadDate = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 4));
+    }
+    sqlite3_finalize(stmt);
+    return states;
+}
+
+bool DatabaseManager::saveFeedState(const std::string& url, const FeedState& state) {
+    std::lock_guard<std::recursive_mutex> lock(dbMutex);
+    const char* sql = R"(
+        INSERT INTO feed_state (url, etag, last_modified, content_hash, download_date) VALUES (?, ?, ?, ?, ?)
+        ON CONFLICT(url) DO UPDATE SET etag = excluded.etag, last_modified = excluded.last_modified,
+            content_hash = excluded.content_hash, download_date = excluded.download_date;
+    )";
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        Logger::getInstance().log("Failed to prepare statement: " + std::string(sqlite3_errmsg(db)));
+        return false;
+    }
+    sqlite3_bind_text(stmt, 1, url.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, state.etag.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 3, state.lastModified.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 4, state.contentHash.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 5, state.downloadDate.c_str(), -1, SQLITE_STATIC);
+    bool ok = sqlite3_step(stmt) == SQLITE_DONE;
+    if (!ok) {
+        Logger::getInstance().log("Failed to save feed state: " + std::string(sqlite3_errmsg(db)));
+    }
+    sqlite3_finalize(stmt);
+    return ok;
+}
+
 bool DatabaseManager::beginTransaction() {
-    std::lock_guard<std::mutex> lock(dbMutex);
+    std::lock_guard<std::recursive_mutex> lock(dbMutex);
     char* errMsg = nullptr;
     if (sqlite3_exec(db, "BEGIN TRANSACTION;", nullptr, nullptr, &errMsg) != SQLITE_OK) {
         Logger::getInstance().log("Failed to begin transaction: " + std::string(errMsg));
@@ -133,7 +725,7 @@ bool DatabaseManager::beginTransaction() {
 }
 
 bool DatabaseManager::commitTransaction() {
-    std::lock_guard<std::mutex> lock(dbMutex);
+    std::lock_guard<std::recursive_mutex> lock(dbMutex);
     char* errMsg = nullptr;
     if (sqlite3_exec(db, "COMMIT;", nullptr, nullptr, &errMsg) != SQLITE_OK) {
         Logger::getInstance().log("Failed to commit transaction: " + std::string(errMsg));
@@ -143,15 +735,172 @@ bool DatabaseManager::commitTransaction() {
     return true;
 }
 
+// Reads a single-valued PRAGMA as text
+bool DatabaseManager::readPragma(const char* name, std::string& value) {
+    sqlite3_stmt* stmt;
+    std::string sql = std::string("PRAGMA ") + name + ";";
+    if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+        Logger::getInstance().log("Failed to read " + std::string(name) + ": " + std::string(sqlite3_errmsg(db)));
+        return false;
+    }
+    bool ok = sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_text(stmt, 0);
+    if (ok) value = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+    sqlite3_finalize(stmt);
+    return ok;
+}
+
+// Puts back the journal mode and synchronous level replaced by configureIngest
+bool DatabaseManager::restoreSettings() {
+    std::lock_guard<std::recursive_mutex> lock(dbMutex);
+    if (savedJournalMode.empty()) return true;
+    std::string sql = "PRAGMA journal_mode=" + savedJournalMode + "; PRAGMA synchronous=" + savedSynchronous + ";";
+    savedJournalMode.clear();
+    savedSynchronous.clear();
+    char* errMsg = nullptr;
+    if (sqlite3_exec(db, sql.c_str(), nullptr, nullptr, &errMsg) != SQLITE_OK) {
+        Logger::getInstance().log("Failed to restore database settings: " + std::string(errMsg));
+        sqlite3_free(errMsg);
+        return false;
+    }
+    return true;
+}
+
 // Batch insert candidates  
 bool DatabaseManager::insertCandidates(const std::vector<Candidate>& candidates, const std::string& date) {
-    if (!beginTransaction()) return false;
+    std::lock_guard<std::recursive_mutex> lock(dbMutex);
+    return insertBatch(candidates, date).committed;
+}
+
+bool DatabaseManager::configureIngest(const IngestSettings& settings) {
+    std::lock_guard<std::recursive_mutex> lock(dbMutex);
+    static const std::vector<std::string> journalModes = { "DELETE", "TRUNCATE", "PERSIST", "MEMORY", "WAL", "OFF" };
+    static const std::vector<std::string> syncModes = { "OFF", "NORMAL", "FULL", "EXTRA" };
 
-    for (const auto& c : candidates) {
-        if (!insertCandidate(c, date)) {
-			continue;
+    std::string journalMode = settings.journalMode;
+    std::string synchronous = settings.synchronous;
+    std::transform(journalMode.begin(), journalMode.end(), journalMode.begin(), ::toupper);
+    std::transform(synchronous.begin(), synchronous.end(), synchronous.begin(), ::toupper);
+    if (std::find(journalModes.begin(), journalModes.end(), journalMode) == journalModes.end()
+        || std::find(syncModes.begin(), syncModes.end(), synchronous) == syncModes.end()) {
+        Logger::getInstance().log("Invalid ingest settings: journal_mode=" + settings.journalMode + ", synchronous=" + settings.synchronous);
+        return false;
+    }
+
+    // A second call before restoreSettings() keeps the settings saved by the first
+    if (savedJournalMode.empty() && (!readPragma("journal_mode", savedJournalMode) || !readPragma("synchronous", savedSynchronous))) {
+        savedJournalMode.clear();
+        return false;
+    }
+
+    std::string sql = "PRAGMA journal_mode=" + journalMode + "; PRAGMA synchronous=" + synchronous + ";";
+    char* errMsg = nullptr;
+    if (sqlite3_exec(db, sql.c_str(), nullptr, nullptr, &errMsg) != SQLITE_OK) {
+        Logger::getInstance().log("Failed to apply ingest settings: " + std::string(errMsg));
+        sqlite3_free(errMsg);
+        restoreSettings();
+        return false;
+    }
+
+    // The multi-row statement depends on the batch size, so rebuild it
+    sqlite3_finalize(insertManyStmt);
+    insertManyStmt = nullptr;
+    rowsPerStatement = settings.rowsPerStatement > 0 ? settings.rowsPerStatement : 1;
+    return prepareInsertStatements();
+}
+
+// Bulk upsert inside one transaction. Statements are prepared once and only
+// reset and rebound per row; full chunks of rowsPerStatement rows are first
+// tried as a single multi-row INSERT, which only succeeds when none of the
+// rows is stored yet. A batch is one slice of one feed, so once a chunk hits a
+// stored key the feed is being ingested again and the rest goes row by row.
+BatchResult DatabaseManager::insertBatch(const std::vector<Candidate>& candidates, const std::string& date) {
+    std::lock_guard<std::recursive_mutex> lock(dbMutex);
+    METRICS_TIMER("insert_us");
+    BatchResult result;
+    if (candidates.empty()) {
+        result.committed = true;
+        return result;
+    }
+    if (!prepareInsertStatements() || !beginTransaction()) {
+        result.failed = candidates.size();
+        return result;
+    }
+
+    SummaryDelta delta;
+    auto upsert = [this, &delta, &result, &date](const Candidate& candidate) {
+        switch (upsertRow(candidate, date, delta)) {
+        case RowOutcome::Inserted: result.inserted++; break;
+        case RowOutcome::Updated: result.updated++; break;
+        case RowOutcome::Duplicate: result.duplicates++; break;
+        case RowOutcome::Failed: result.failed++; break;
         }
+    };
+
+    size_t i = 0;
+    bool storedKey = false;
+    while (insertManyStmt && !storedKey && candidates.size() - i >= rowsPerStatement) {
+        bool savepoint = openSavepoint();
+        bool ok = savepoint;
+        for (size_t row = 0; row < rowsPerStatement && ok; ++row) {
+            ok = bindCandidate(insertManyStmt, static_cast<int>(row * insertColumns + 1), candidates[i + row], date);
+        }
+        if (ok) {
+            ok = sqlite3_step(insertManyStmt) == SQLITE_DONE;
+            storedKey = !ok && sqlite3_extended_errcode(db) == SQLITE_CONSTRAINT_UNIQUE;
+        }
+        sqlite3_reset(insertManyStmt);
+        sqlite3_clear_bindings(insertManyStmt);
+
+        if (ok) {
+            // Skills are linked by position: one INSERT into a rowid table takes
+            // new ids in VALUES order, ending at last_insert_rowid(), as long as
+            // no other statement inserts in between. dbMutex and the open write
+            // transaction rule that out; both ends are checked in case it breaks.
+            sqlite3_int64 lastId = sqlite3_last_insert_rowid(db);
+            sqlite3_int64 firstId = lastId - static_cast<sqlite3_int64>(rowsPerStatement) + 1;
+            ok = findId(candidates[i], date) == firstId && findId(candidates[i + rowsPerStatement - 1], date) == lastId;
+            if (!ok) {
+                Logger::getInstance().log(LogLevel::Warning, "Multi-row insert did not take consecutive ids, inserting row by row");
+            }
+            for (size_t row = 0; row < rowsPerStatement && ok; ++row) {
+                ok = insertSkills(firstId + static_cast<sqlite3_int64>(row), candidates[i + row].skills);
+            }
+        }
+        if (savepoint) closeSavepoint(ok);
+
+        if (ok) {
+            for (size_t row = 0; row < rowsPerStatement; ++row) {
+                addToSummary(delta, candidates[i + row]);
+            }
+            result.inserted += rowsPerStatement;
+        }
+        else {
+            // A stored key, an invalid row or a failed skill insert undoes the
+            // whole chunk; upsert it row by row so only the bad rows are lost
+            for (size_t row = 0; row < rowsPerStatement; ++row) {
+                upsert(candidates[i + row]);
+            }
+        }
+        i += rowsPerStatement;
     }
 
-    return commitTransaction();
-}
\ No newline at end of file
+    for (; i < candidates.size(); ++i) {
+        upsert(candidates[i]);
+    }
+
+    result.committed = applySummary(delta, date) && commitTransaction();
+    if (!result.committed) {
+        sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+        skillIds.clear(); // Ids of rolled back skills are no longer valid
+        result.failed += result.inserted + result.updated + result.duplicates;
+        result.inserted = result.updated = result.duplicates = 0;
+    }
+
+    LOG_DEBUG("Inserted " + std::to_string(result.inserted) + " candidates, " + std::to_string(result.updated) + " updated, "
+        + std::to_string(result.duplicates) + " duplicates, " + std::to_string(result.failed) + " rejected");
+    METRICS_COUNT("rows_inserted", result.inserted);
+    METRICS_COUNT("rows_updated", result.updated);
+    METRICS_COUNT("rows_duplicate", result.duplicates);
+    METRICS_COUNT("rows_failed", result.failed);
+    return result;
+}
@@ -1,22 +1,109 @@
 #pragma once  
 #include <sqlite3.h>
+#include <unordered_map>
 #include <vector>  
 #include "DataParser.h"
+#include "PersistenceHandler.h"
+
+// Connection settings applied for bulk ingest sessions
+struct IngestSettings {
+    std::string journalMode = "WAL";    // DELETE, TRUNCATE, PERSIST, MEMORY, WAL or OFF
+    std::string synchronous = "NORMAL"; // OFF, NORMAL, FULL or EXTRA
+    size_t rowsPerStatement = 100;      // Rows bound into one multi-row INSERT ... VALUES
+};
+
+// Outcome of one insertBatch call
+struct BatchResult {
+    size_t inserted = 0;
+    size_t updated = 0;    // Rows already stored for the date whose content changed
+    size_t duplicates = 0; // Rows already stored for the date unchanged; left as they were
+    size_t failed = 0;
+    bool committed = false;
+};
+
+// One row of the per-date university summary table
+struct UniversitySummary {
+    std::string university;
+    int candidates = 0;
+    double gpaSum = 0.0;
+};
+
+// Validators of the last inserted download of a feed, sent back as a conditional request
+struct FeedState {
+    std::string etag;
+    std::string lastModified;
+    std::string contentHash;  // DataDownloader::contentHash of the body
+    std::string downloadDate; // Date the body was inserted for
+};
 
 class DatabaseManager {
 private:
     sqlite3* db;
+    sqlite3_stmt* insertStmt;     // Single-row upsert on the (download_date, university, name) key, prepared once and reused
+    sqlite3_stmt* insertManyStmt; // Multi-row INSERT with rowsPerStatement rows
+    sqlite3_stmt* findStmt;       // Existing row for a key
+    sqlite3_stmt* selectCandidateSkillsStmt;
+    sqlite3_stmt* deleteCandidateSkillsStmt;
+    sqlite3_stmt* selectSkillStmt;
+    sqlite3_stmt* insertSkillStmt;
+    sqlite3_stmt* insertCandidateSkillStmt;
+    sqlite3_stmt* savepointStmt;  // SAVEPOINT, RELEASE and ROLLBACK TO around the writes of one row
+    sqlite3_stmt* releaseStmt;
+    sqlite3_stmt* rollbackToStmt;
+    size_t rowsPerStatement;
+    std::unordered_map<std::string, sqlite3_int64> skillIds; // Cache of the skills dictionary
+    std::vector<std::string> savepointSkills; // Added to the dictionary since the open savepoint
+    bool savepointOpen;
+    std::string savedJournalMode; // Settings replaced by configureIngest, empty outside an ingest
+    std::string savedSynchronous;
+
+    // Summary rows added by the current insert, written before it commits
+    struct SummaryDelta {
+        std::unordered_map<std::string, UniversitySummary> universities;
+        std::unordered_map<sqlite3_int64, int> skills;
+    };
+    enum class RowOutcome { Inserted, Updated, Duplicate, Failed };
     static DatabaseManager* instance;
-    DatabaseManager() : db(nullptr) {}  // Private constructor
+    DatabaseManager() : db(nullptr), insertStmt(nullptr), insertManyStmt(nullptr), findStmt(nullptr), selectCandidateSkillsStmt(nullptr),
+        deleteCandidateSkillsStmt(nullptr), selectSkillStmt(nullptr), insertSkillStmt(nullptr), insertCandidateSkillStmt(nullptr),
+        savepointStmt(nullptr), releaseStmt(nullptr), rollbackToStmt(nullptr), rowsPerStatement(100), savepointOpen(false) {}  // Private constructor
+
+    bool prepareInsertStatements();
+    void finalizeStatements();
+    bool bindCandidate(sqlite3_stmt* stmt, int firstParam, const Candidate& candidate, const std::string& downloadDate);
+    bool openSavepoint();
+    void closeSavepoint(bool keep);
+    sqlite3_int64 findId(const Candidate& candidate, const std::string& downloadDate);
+    RowOutcome upsertRow(const Candidate& candidate, const std::string& downloadDate, SummaryDelta& delta);
+    bool insertSkills(sqlite3_int64 candidateId, const std::vector<std::string>& skills);
+    bool lookupSkillId(const std::string& skill, bool create, sqlite3_int64& id);
+    std::vector<Candidate> readCandidates(sqlite3_stmt* stmt);
+    bool readPragma(const char* name, std::string& value);
+    bool migrateLegacySkills();
+    bool migrateDedupKey();
+    void addToSummary(SummaryDelta& delta, const Candidate& candidate);
+    bool applySummary(const SummaryDelta& delta, const std::string& date);
 
 public:
     static DatabaseManager& getInstance();
     bool open(const std::string& dbPath);
     void close();
     bool createTables();
+    bool migrateSchema();
     bool insertCandidate(const Candidate& candidate, const std::string& downloadDate);
     std::vector<Candidate> getCandidatesByDate(const std::string& date);
+    std::vector<Candidate> queryCandidates(const FilterData& filter);
+    std::vector<std::pair<std::string, int>> getSkillCounts(const std::string& date);
+    std::vector<UniversitySummary> getUniversitySummary(const std::string& date);
+    bool rebuildSummaries();
+    std::unordered_map<std::string, FeedState> getFeedStates();
+    bool saveFeedState(const std::string& url, const FeedState& state);
     bool beginTransaction();
     bool commitTransaction();
     bool insertCandidates(const std::vector<Candidate>& candidates, const std::string& date);
+    // Applies the settings until restoreSettings(); journal_mode is stored in
+    // the database file, so without the restore it outlives the session
+    bool configureIngest(const IngestSettings& settings);
+    bool restoreSettings();
+    BatchResult insertBatch(const std::vector<Candidate>& candidates, const std::string& date);
 };
\ No newline at end of file
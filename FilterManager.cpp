@@ -1,8 +1,10 @@
 #include "FilterManager.h"
+#include "Metrics.h"
 #include <algorithm>
 #include <iterator>
 
 std::vector<Candidate> FilterManager::filterByGPA(const std::vector<Candidate>& candidates, double min, double max) {
+    METRICS_TIMER("filter_us");
     std::vector<Candidate> result;
     std::copy_if(candidates.begin(), candidates.end(), std::back_inserter(result),
         [min, max](const Candidate& c) { return c.gpa >= min && c.gpa <= max; });
@@ -10,6 +12,7 @@ std::vector<Candidate> FilterManager::filterByGPA(const std::vector<Candidate>&
 }
 
 std::vector<Candidate> FilterManager::filterByUniversity(const std::vector<Candidate>& candidates, const std::string& university) {
+    METRICS_TIMER("filter_us");
     std::vector<Candidate> result;
     std::copy_if(candidates.begin(), candidates.end(), std::back_inserter(result),
         [university](const Candidate& c) { return c.university == university; });
@@ -17,13 +20,76 @@ std::vector<Candidate> FilterManager::filterByUniversity(const std::vector<Candi
 }
 
 std::vector<Candidate> FilterManager::filterBySkills(const std::vector<Candidate>& candidates, const std::vector<std::string>& requiredSkills) {
+    METRICS_TIMER("filter_us");
     std::vector<Candidate> result;
     std::copy_if(candidates.begin(), candidates.end(), std::back_inserter(result),
-        [requiredSkills](const Candidate& c) {
+        [&requiredSkills](const Candidate& c) {
             for (const auto& skill : requiredSkills) {
                 if (std::find(c.skills.begin(), c.skills.end(), skill) == c.skills.end()) return false;
             }
             return true;
         });
     return result;
+}
+
+Selection FilterManager::filterByGPA(const CandidateStore& store, const Selection& rows, double min, double max) {
+    METRICS_TIMER("filter_us");
+    const std::vector<double>& gpas = store.gpas();
+    Selection result;
+    std::copy_if(rows.begin(), rows.end(), std::back_inserter(result),
+        [&gpas, min, max](RowIndex row) { return gpas[row] >= min && gpas[row] <= max; });
+    return result;
+}
+
+Selection FilterManager::filterByUniversity(const CandidateStore& store, const Selection& rows, const std::string& university) {
+    METRICS_TIMER("filter_us");
+    uint32_t universityId;
+    if (!store.universities().find(university, universityId)) return {};
+    const std::vector<uint32_t>& universities = store.universityIds();
+    Selection result;
+    std::copy_if(rows.begin(), rows.end(), std::back_inserter(result),
+        [&universities, universityId](RowIndex row) { return universities[row] == universityId; });
+    return result;
+}
+
+namespace {
+
+// Resolves skill names to dictionary ids; false if any skill is unknown
+bool resolveSkills(const CandidateStore& store, const std::vector<std::string>& requiredSkills, std::vector<uint32_t>& required) {
+    for (const auto& skill : requiredSkills) {
+        uint32_t id;
+        if (!store.skills().find(skill, id)) return false;
+        required.push_back(id);
+    }
+    return true;
+}
+
+}
+
+Selection FilterManager::filterBySkills(const CandidateStore& store, const Selection& rows, const std::vector<std::string>& requiredSkills) {
+    METRICS_TIMER("filter_us");
+    // Resolve the names once; afterwards only integer ids are compared
+    std::vector<uint32_t> required;
+    if (!resolveSkills(store, requiredSkills, required)) return {};
+    Selection result;
+    std::copy_if(rows.begin(), rows.end(), std::back_inserter(result),
+        [&store, &required](RowIndex row) {
+            for (uint32_t id : required) {
+                if (std::find(store.skillsBegin(row), store.skillsEnd(row), id) == store.skillsEnd(row)) return false;
+            }
+            return true;
+        });
+    return result;
+}
+
+Selection FilterManager::filterBySkills(const CandidateStore& store, const SkillBitsetIndex& bitsets, const Selection& rows, const std::vector<std::string>& requiredSkills) {
+    // Bitsets built before rows were added cannot answer for the new rows
+    if (bitsets.rows() != store.size()) return filterBySkills(store, rows, requiredSkills);
+    METRICS_TIMER("filter_us");
+    std::vector<uint32_t> required;
+    if (!resolveSkills(store, requiredSkills, required)) return {};
+    std::vector<uint64_t> mask;
+    // Skills interned after the bitsets were built are held by no indexed row
+    if (!bitsets.makeMask(required, mask)) return {};
+    return bitsets.filter(rows, mask);
 }
\ No newline at end of file
@@ -1,5 +1,7 @@
 #pragma once
+#include "CandidateStore.h"
 #include "DataParser.h"
+#include "SkillBitset.h"
 #include <functional>
 
 class FilterManager {
@@ -7,4 +9,11 @@ public:
     static std::vector<Candidate> filterByGPA(const std::vector<Candidate>& candidates, double min, double max);
     static std::vector<Candidate> filterByUniversity(const std::vector<Candidate>& candidates, const std::string& university);
     static std::vector<Candidate> filterBySkills(const std::vector<Candidate>& candidates, const std::vector<std::string>& requiredSkills);
+
+    // CandidateStore overloads: narrow a selection of row indices without copying candidates
+    static Selection filterByGPA(const CandidateStore& store, const Selection& rows, double min, double max);
+    static Selection filterByUniversity(const CandidateStore& store, const Selection& rows, const std::string& university);
+    static Selection filterBySkills(const CandidateStore& store, const Selection& rows, const std::vector<std::string>& requiredSkills);
+    // Same result using the store's skill bitsets, a vectorized AND/compare per row
+    static Selection filterBySkills(const CandidateStore& store, const SkillBitsetIndex& bitsets, const Selection& rows, const std::vector<std::string>& requiredSkills);
 };
\ No newline at end of file
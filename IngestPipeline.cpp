@@ -0,0 +1,203 @@
+#include "IngestPipeline.h"
+#include "Logger.h"
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <unordered_set>
+
+IngestPipeline::IngestPipeline(DataDownloader& downloader, DatabaseManager& db, const PipelineOptions& options)
+    : downloader(downloader), db(db), options(options), failures(0), cancelled(false) {}
+
+// End-of-feed marker carrying the feed's status and validators to the writer
+static ParsedFeed endMarker(const FeedPayload& payload) {
+    ParsedFeed end;
+    end.url = payload.url;
+    end.university = payload.university;
+    end.endOfFeed = true;
+    end.failed = payload.failed;
+    end.unchanged = payload.unchanged;
+    end.state = payload.state;
+    return end;
+}
+
+// Forwards candidates in batches so the writer can start before the feed is fully parsed
+CandidateSink IngestPipeline::forwardTo(const FeedPayload& payload, BoundedQueue<ParsedFeed>& out) {
+    return [this, &payload, &out](std::vector<Candidate>& batch) {
+        if (cancelled) return;
+        ParsedFeed feed;
+        feed.url = payload.url;
+        feed.university = payload.university;
+        feed.candidates = std::move(batch);
+        out.push(std::move(feed));
+    };
+}
+
+// Download stage: workers take the next URL and hand the body over in memory,
+// or parse it straight off the connection when streamToParser is set
+void IngestPipeline::downloadStage(const std::vector<std::string>& urls, const std::string& date, std::atomic<size_t>& nextUrl,
+    BoundedQueue<FeedPayload>& out, BoundedQueue<ParsedFeed>& parsed) {
+    for (size_t i = nextUrl++; i < urls.size() && !cancelled; i = nextUrl++) {
+        const std::string& url = urls[i];
+        FeedPayload payload;
+        payload.url = url;
+        payload.university = downloader.extractUniversityName(url);
+        payload.fileType = downloader.getFileExtension(url);
+
+        // Rows are stored per date, so validators from an earlier day cannot skip today's insert
+        auto known = feedStates.find(url);
+        if (options.conditionalFetch && known != feedStates.end() && known->second.downloadDate == date) {
+            payload.state = known->second;
+        }
+
+        if (options.streamToParser && !options.saveToDisk) {
+            std::unique_ptr<Parser> parser(ParserFactory::createParser(payload.fileType));
+            bool parsedAll = false;
+            if (parser) {
+                outcomes[i] = downloader.streamFeedIfChanged(url, options.maxRetries, payload.state, [&](std::istream& body) {
+                    parsedAll = parser->parseStream(body, payload.university, forwardTo(payload, parsed), options.parseBatchSize);
+                });
+            }
+            // A body that does not parse to the end fails the feed too, so its validators are not saved
+            FetchResult result = outcomes[i].result;
+            if (!parser || result == FetchResult::Failed || (result == FetchResult::Downloaded && !parsedAll)) {
+                failures++;
+                payload.failed = true;
+            }
+            payload.unchanged = outcomes[i].result == FetchResult::Unchanged;
+            parsed.push(endMarker(payload));
+            continue;
+        }
+
+        if (options.saveToDisk) {
+            // The body goes to disk as it arrives and the parse stage maps the file
+            std::string filename = downloader.url_to_filename(url);
+            outcomes[i] = downloader.saveFeedIfChanged(url, options.maxRetries, payload.state, filename);
+            if (outcomes[i].result == FetchResult::Downloaded) {
+                payload.path = filename;
+            }
+        }
+        else {
+            outcomes[i] = downloader.fetchFeedIfChanged(url, options.maxRetries, payload.state, payload.data);
+        }
+        FetchResult result = outcomes[i].result;
+        if (result == FetchResult::Failed) {
+            failures++;
+            payload.failed = true; // Still forwarded so the writer can count the feed as done
+        }
+        else if (result == FetchResult::Unchanged) {
+            payload.unchanged = true;
+        }
+        out.push(std::move(payload));
+    }
+}
+
+// Parse stage: turn each feed body into batches of candidates
+void IngestPipeline::parseStage(BoundedQueue<FeedPayload>& in, BoundedQueue<ParsedFeed>& out) {
+    FeedPayload payload;
+    while (in.pop(payload)) {
+        if (cancelled) continue;
+        ParsedFeed end = endMarker(payload);
+        bool parse = !payload.failed && !payload.unchanged;
+        std::unique_ptr<Parser> parser(parse ? ParserFactory::createParser(payload.fileType) : nullptr);
+        if (parse && !parser) {
+            failures++;
+            end.failed = true;
+        }
+        // A malformed or truncated body fails the feed: the rows read so far are
+        // kept, but its validators are not saved, so the next run fetches it again
+        bool parsedAll = true;
+        if (parser && !payload.path.empty()) {
+            parsedAll = parser->parseFile(payload.path, payload.university, forwardTo(payload, out), options.parseBatchSize);
+        }
+        else if (parser) {
+            parsedAll = parser->parseStream(payload.data, payload.university, forwardTo(payload, out), options.parseBatchSize);
+        }
+        if (!parsedAll) {
+            failures++;
+            end.failed = true;
+        }
+        out.push(std::move(end));
+    }
+}
+
+// Writer stage: the only stage that touches the database
+bool IngestPipeline::writeStage(BoundedQueue<ParsedFeed>& in, const std::string& date, IngestProgress& progress) {
+    bool ok = true;
+    std::unordered_set<std::string> incomplete; // Feeds with a batch that did not commit
+    ParsedFeed feed;
+    while (in.pop(feed)) {
+        if (cancelled) continue; // Drain so the other stages can finish
+        progress.university = feed.university;
+        progress.feedFinished = feed.endOfFeed;
+        if (feed.endOfFeed) {
+            progress.feedsDone++;
+            if (feed.failed) progress.feedsFailed++;
+            if (feed.unchanged) progress.feedsUnchanged++;
+            // Remember the validators only once the whole body is in the database
+            if (!feed.failed && !incomplete.count(feed.url)) {
+                feed.state.downloadDate = date;
+                db.saveFeedState(feed.url, feed.state);
+            }
+            report(progress);
+            continue;
+        }
+
+        BatchResult result = db.insertBatch(feed.candidates, date);
+        progress.rowsInserted += result.inserted;
+        progress.rowsUpdated += result.updated;
+        progress.rowsDuplicate += result.duplicates;
+        progress.rowsFailed += result.failed;
+        if (!result.committed) {
+            Logger::getInstance().log("Failed to insert candidates for: " + feed.university);
+            incomplete.insert(feed.url);
+            ok = false;
+        }
+        report(progress);
+    }
+    return ok;
+}
+
+void IngestPipeline::report(const IngestProgress& progress) {
+    if (onProgress) onProgress(progress);
+}
+
+bool IngestPipeline::run(const std::vector<std::string>& urls, const std::string& date) {
+    failures = 0;
+    IngestProgress progress;
+    progress.feedsTotal = urls.size();
+    if (!db.configureIngest(options.ingest)) {
+        Logger::getInstance().log(LogLevel::Warning, "Using default database settings for ingest");
+    }
+    outcomes.assign(urls.size(), FetchOutcome());
+    feedStates = options.conditionalFetch ? db.getFeedStates() : std::unordered_map<std::string, FeedState>();
+    BoundedQueue<FeedPayload> rawQueue(options.queueCapacity);
+    BoundedQueue<ParsedFeed> parsedQueue(options.queueCapacity);
+    std::atomic<size_t> nextUrl(0);
+
+    std::vector<std::thread> downloaders;
+    for (size_t i = 0; i < std::max<size_t>(options.downloadWorkers, 1); ++i) {
+        downloaders.emplace_back(&IngestPipeline::downloadStage, this, std::cref(urls), std::cref(date), std::ref(nextUrl), std::ref(rawQueue), std::ref(parsedQueue));
+    }
+    std::vector<std::thread> parsers;
+    for (size_t i = 0; i < std::max<size_t>(options.parseWorkers, 1); ++i) {
+        parsers.emplace_back(&IngestPipeline::parseStage, this, std::ref(rawQueue), std::ref(parsedQueue));
+    }
+
+    // Close each queue once every producer feeding it has finished
+    std::thread closer([&]() {
+        for (auto& t : downloaders) t.join();
+        rawQueue.close();
+        for (auto& t : parsers) t.join();
+        parsedQueue.close();
+    });
+
+    bool ok = writeStage(parsedQueue, date, progress);
+    closer.join();
+    db.restoreSettings();
+
+    progress.university.clear();
+    progress.feedFinished = false;
+    progress.finished = true;
+    report(progress);
+    return ok && failures == 0 && !cancelled;
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include "BoundedQueue.h"
+#include "DataDownloader.h"
+#include "DatabaseManager.h"
+#include <atomic>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Feed body handed from the download stage to the parse stage
+struct FeedPayload {
+    std::string url;
+    std::string university;
+    std::string fileType;
+    std::string data;
+    std::string path;       // Saved copy of the body when saveToDisk is set; parsed instead of data
+    FeedState state;        // Validators of this download, saved once it is inserted
+    bool failed = false;    // The download failed; only url and university are set
+    bool unchanged = false; // Same body as the last insert for this date; data is empty
+};
+
+// Batch of parsed candidates handed from the parse stage to the database writer
+struct ParsedFeed {
+    std::string url;
+    std::string university;
+    std::vector<Candidate> candidates;
+    bool endOfFeed = false; // Marker sent once a feed is fully parsed (or failed)
+    bool failed = false;
+    bool unchanged = false;
+    FeedState state;        // Set on the end marker only
+};
+
+// Running totals reported by the writer after every batch and every finished feed
+struct IngestProgress {
+    size_t feedsTotal = 0;
+    size_t feedsDone = 0;   // Feeds fully inserted or failed
+    size_t feedsFailed = 0;
+    size_t feedsUnchanged = 0; // Feeds skipped because they did not change since the last insert
+    size_t rowsInserted = 0;
+    size_t rowsUpdated = 0;
+    size_t rowsDuplicate = 0; // Rows already stored unchanged for the date
+    size_t rowsFailed = 0;
+    std::string university; // Feed the update is about
+    bool feedFinished = false;
+    bool finished = false;  // Last update of the run
+};
+
+// Called on the thread running IngestPipeline::run
+using IngestProgressCallback = std::function<void(const IngestProgress&)>;
+
+struct PipelineOptions {
+    size_t downloadWorkers = 4;
+    size_t parseWorkers = 2;
+    size_t queueCapacity = 8;
+    size_t parseBatchSize = 1000;
+    int maxRetries = 3;
+    bool saveToDisk = false; // Keep an on-disk copy of every downloaded feed
+    bool conditionalFetch = true; // Skip feeds that did not change since they were inserted for the same date
+    // Parse bodies on the download workers as they arrive instead of buffering them.
+    // Memory per feed stays at one chunk plus one batch, but only a 304 marks a
+    // feed unchanged, and it is ignored when saveToDisk is set.
+    bool streamToParser = false;
+    IngestSettings ingest;
+};
+
+// Download -> parse -> insert pipeline. Each stage runs on its own threads and
+// the stages are connected by bounded queues, so a fast feed is inserted while
+// a slow one is still downloading.
+class IngestPipeline {
+public:
+    IngestPipeline(DataDownloader& downloader, DatabaseManager& db, const PipelineOptions& options = PipelineOptions());
+    bool run(const std::vector<std::string>& urls, const std::string& date);
+    void setProgressCallback(IngestProgressCallback callback) { onProgress = std::move(callback); }
+    // Asks a running pipeline to stop: no new feeds are fetched, downloads in
+    // flight are aborted and queued work is dropped
+    void cancel() { cancelled = true; downloader.cancel(); }
+    // Download outcome of every URL of the last run, in URL order
+    const std::vector<FetchOutcome>& fetchOutcomes() const { return outcomes; }
+
+private:
+    void downloadStage(const std::vector<std::string>& urls, const std::string& date, std::atomic<size_t>& nextUrl,
+        BoundedQueue<FeedPayload>& out, BoundedQueue<ParsedFeed>& parsed);
+    CandidateSink forwardTo(const FeedPayload& payload, BoundedQueue<ParsedFeed>& out);
+    void parseStage(BoundedQueue<FeedPayload>& in, BoundedQueue<ParsedFeed>& out);
+    bool writeStage(BoundedQueue<ParsedFeed>& in, const std::string& date, IngestProgress& progress);
+    void report(const IngestProgress& progress);
+
+    DataDownloader& downloader;
+    DatabaseManager& db;
+    PipelineOptions options;
+    std::atomic<int> failures;
+    std::atomic<bool> cancelled;
+    IngestProgressCallback onProgress;
+    std::unordered_map<std::string, FeedState> feedStates; // Loaded at the start of run(), read-only afterwards
+    std::vector<FetchOutcome> outcomes; // One slot per URL, each written by the worker that took it
+};
@@ -1,6 +1,18 @@
 #include "Logger.h"
+#include <chrono>
+#include <cstddef>
 
-Logger::Logger() {
+static const char* levelTag(LogLevel level) {
+    switch (level) {
+    case LogLevel::Debug: return "[DEBUG] ";
+    case LogLevel::Info: return "[INFO] ";
+    case LogLevel::Warning: return "[WARNING] ";
+    default: return "[ERROR] ";
+    }
+}
+
+Logger::Logger()
+    : minLevel(static_cast<int>(LogLevel::Info)), async(false), tail(0), written(0), dropped(0), pushing(0), stopping(false), writerIdle(false) {
     logFile.open("errors.log", std::ios::app);
 }
 
@@ -10,14 +22,165 @@ Logger& Logger::getInstance() {
 }
 
 void Logger::log(const std::string& message) {
+    log(LogLevel::Error, message);
+}
+
+void Logger::log(LogLevel level, const std::string& message) {
+    if (static_cast<int>(level) < minLevel.load(std::memory_order_relaxed)) return;
+    if (async.load(std::memory_order_acquire)) {
+        // Registering before the second check lets shutdown() wait for every
+        // producer that still saw the async mode
+        pushing.fetch_add(1);
+        if (async.load()) {
+            push(level, message); // Dropped messages are counted in push()
+            pushing.fetch_sub(1, std::memory_order_release);
+            return;
+        }
+        pushing.fetch_sub(1, std::memory_order_relaxed);
+    }
+
     std::lock_guard<std::mutex> lock(mtx);
+    writeLine(level, message);
+    logFile.flush();
+}
+
+void Logger::writeLine(LogLevel level, const std::string& message) {
     if (logFile.is_open()) {
-        logFile << "[ERROR] " << message << std::endl;
+        logFile << levelTag(level) << message << '\n';
+    }
+}
+
+// Bounded MPSC queue after Dmitry Vyukov's array queue: a producer claims a
+// slot by advancing tail with a CAS, fills it and publishes it by bumping the
+// slot's sequence; the writer hands the slot back one lap later.
+bool Logger::push(LogLevel level, const std::string& message) {
+    size_t pos = tail.load(std::memory_order_relaxed);
+    Slot* slot;
+    for (;;) {
+        slot = &slots[pos & mask];
+        size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+        if (diff == 0) {
+            if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        }
+        else if (diff < 0) {
+            // Full
+            if (overflow == LogOverflow::Drop && level != LogLevel::Error) {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            wake.notify_one();
+            std::this_thread::yield();
+            pos = tail.load(std::memory_order_relaxed);
+        }
+        else {
+            pos = tail.load(std::memory_order_relaxed);
+        }
+    }
+    slot->level = level;
+    slot->message = message;
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    if (writerIdle.load(std::memory_order_relaxed)) wake.notify_one();
+    return true;
+}
+
+// Writes every published slot; returns how many were written
+size_t Logger::drain() {
+    size_t count = 0;
+    std::lock_guard<std::mutex> lock(mtx);
+    for (;;) {
+        Slot& slot = slots[head & mask];
+        if (slot.sequence.load(std::memory_order_acquire) != head + 1) break;
+        writeLine(slot.level, slot.message);
+        slot.message.clear();
+        slot.sequence.store(head + mask + 1, std::memory_order_release);
+        head++;
+        count++;
     }
+    size_t lost = dropped.exchange(0, std::memory_order_relaxed);
+    if (lost > 0) {
+        writeLine(LogLevel::Warning, std::to_string(lost) + " log messages dropped, buffer full");
+    }
+    if (count > 0 || lost > 0) logFile.flush();
+    written.fetch_add(count, std::memory_order_release);
+    return count;
+}
+
+void Logger::writerLoop() {
+    for (;;) {
+        bool stop = stopping.load(std::memory_order_acquire);
+        size_t count = drain();
+        drained.notify_all();
+        if (stop && count == 0) break;
+        if (count == 0) {
+            // A wake-up can slip in between the empty drain and the wait, so
+            // the wait is bounded; it only delays that message by one period
+            std::unique_lock<std::mutex> lock(wakeMtx);
+            writerIdle = true;
+            wake.wait_for(lock, std::chrono::milliseconds(50));
+            writerIdle = false;
+        }
+    }
+}
+
+void Logger::startAsync(size_t capacity, LogOverflow policy) {
+    std::lock_guard<std::mutex> lock(wakeMtx);
+    if (async) return;
+    size_t size = 2;
+    while (size < capacity) size *= 2;
+    slots.reset(new Slot[size]);
+    for (size_t i = 0; i < size; ++i) {
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    mask = size - 1;
+    overflow = policy;
+    tail = 0;
+    head = 0;
+    written = 0;
+    stopping = false;
+    writer = std::thread(&Logger::writerLoop, this);
+    async.store(true, std::memory_order_release);
+}
+
+void Logger::flush() {
+    if (!async.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(mtx);
+        logFile.flush();
+        return;
+    }
+    size_t target = tail.load(std::memory_order_acquire);
+    std::unique_lock<std::mutex> lock(wakeMtx);
+    wake.notify_one();
+    drained.wait(lock, [this, target] { return written.load(std::memory_order_acquire) >= target || !async.load(std::memory_order_acquire); });
+}
+
+void Logger::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMtx);
+        if (!async) return;
+        // New messages are written directly from here on
+        async.store(false);
+    }
+    // The writer keeps draining while the producers that got in before the
+    // switch publish their slots, so blocked ones get room too; afterwards
+    // tail no longer moves and the writer stops once it has caught up
+    while (pushing.load() != 0) {
+        wake.notify_one();
+        std::this_thread::yield();
+    }
+    {
+        std::lock_guard<std::mutex> lock(wakeMtx);
+        stopping = true;
+    }
+    wake.notify_one();
+    drained.notify_all();
+    writer.join();
+    drain();
 }
 
 Logger::~Logger() {
+    shutdown();
     if (logFile.is_open()) {
         logFile.close();
     }
-}
\ No newline at end of file
+}
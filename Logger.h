@@ -1,16 +1,83 @@
 #pragma once
+#include <atomic>
+#include <condition_variable>
 #include <fstream>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
 
+enum class LogLevel { Debug, Info, Warning, Error };
+
+// What a producer does when the async buffer is full. Errors always wait.
+enum class LogOverflow {
+    Drop,  // Discard the message; the writer reports how many were lost
+    Block  // Wait for the writer to make room
+};
+
+// Lowest level LOG_DEBUG compiles in: 0 keeps debug messages, anything else
+// removes them, including the evaluation of their arguments
+#ifndef LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define LOG_MIN_LEVEL 1
+#else
+#define LOG_MIN_LEVEL 0
+#endif
+#endif
+
+#define LOG_DEBUG(message) \
+    do { if (LOG_MIN_LEVEL <= 0) Logger::getInstance().log(LogLevel::Debug, message); } while (0)
+
+// Writes "[LEVEL] message" lines to errors.log. By default every call writes
+// and flushes under a mutex. After startAsync() producers only push into a
+// lock-free ring buffer and a background thread writes the lines in batches,
+// flushing once per batch.
 class Logger {
 private:
-    std::mutex mtx;
+    // One ring buffer entry; sequence tells producers and the writer whose turn it is
+    struct Slot {
+        std::atomic<size_t> sequence;
+        LogLevel level;
+        std::string message;
+    };
+
+    std::mutex mtx; // Guards logFile
     std::ofstream logFile;
+    std::atomic<int> minLevel;
+
+    std::unique_ptr<Slot[]> slots;
+    size_t mask = 0;
+    LogOverflow overflow = LogOverflow::Drop;
+    std::atomic<bool> async;
+    std::atomic<size_t> tail;    // Next slot a producer claims
+    size_t head = 0;             // Next slot the writer reads; writer thread only
+    std::atomic<size_t> written; // Slots the writer has consumed
+    std::atomic<size_t> dropped;
+    std::atomic<int> pushing;    // Producers between their async check and publishing
+    std::atomic<bool> stopping;
+    std::atomic<bool> writerIdle;
+    std::mutex wakeMtx;
+    std::condition_variable wake;    // Wakes the writer
+    std::condition_variable drained; // Signalled after every batch
+    std::thread writer;
+
     Logger(); // Private constructor
+    bool push(LogLevel level, const std::string& message);
+    void writeLine(LogLevel level, const std::string& message);
+    void writerLoop();
+    size_t drain();
 
 public:
     static Logger& getInstance();
-    void log(const std::string& message);
+    void log(const std::string& message); // Logged as an error
+    void log(LogLevel level, const std::string& message);
+    void setLevel(LogLevel level) { minLevel = static_cast<int>(level); }
+
+    // Switches to the background writer; capacity is rounded up to a power of two
+    void startAsync(size_t capacity = 8192, LogOverflow policy = LogOverflow::Drop);
+    // Waits until everything logged so far is written and flushed
+    void flush();
+    // Writes what is queued, stops the writer and returns to synchronous logging
+    void shutdown();
     ~Logger();
-};
\ No newline at end of file
+};
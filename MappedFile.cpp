@@ -0,0 +1,79 @@
+#include "MappedFile.h"
+#include "Logger.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Empty files cannot be mapped; they are exposed as an empty range instead
+static const char emptyFile[] = "";
+
+bool MappedFile::open(const std::string& path) {
+    close();
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        Logger::getInstance().log("Failed to open file: " + path);
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    bool ok = GetFileSizeEx(file, &fileSize) != 0;
+    if (ok && fileSize.QuadPart > 0) {
+        // The view keeps the mapping and the file alive once both handles are closed
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        const void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (mapping) CloseHandle(mapping);
+        ok = view != nullptr;
+        bytes = static_cast<const char*>(view);
+        length = static_cast<size_t>(fileSize.QuadPart);
+    }
+    CloseHandle(file);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        Logger::getInstance().log("Failed to open file: " + path);
+        return false;
+    }
+    struct stat info;
+    bool ok = fstat(fd, &info) == 0;
+    if (ok && info.st_size > 0) {
+        void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ok = view != MAP_FAILED;
+        if (ok) {
+            madvise(view, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+            bytes = static_cast<const char*>(view);
+            length = static_cast<size_t>(info.st_size);
+        }
+    }
+    ::close(fd);
+#endif
+    if (!ok) {
+        Logger::getInstance().log("Failed to map file: " + path);
+        bytes = nullptr;
+        length = 0;
+        return false;
+    }
+    if (!bytes) bytes = emptyFile;
+    opened = true;
+    return true;
+}
+
+void MappedFile::close() {
+    if (opened && length > 0) {
+#if defined(_WIN32)
+        UnmapViewOfFile(bytes);
+#else
+        munmap(const_cast<char*>(bytes), length);
+#endif
+    }
+    bytes = nullptr;
+    length = 0;
+    opened = false;
+}
@@ -0,0 +1,133 @@
+#include "Metrics.h"
+#include "Logger.h"
+#include <fstream>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+// Index of the highest set bit; value must not be zero
+static int highestBit64(uint64_t value) {
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return static_cast<int>(index);
+#elif defined(__GNUC__)
+    return 63 - __builtin_clzll(value);
+#else
+    int index = 0;
+    while (value >>= 1) index++;
+    return index;
+#endif
+}
+
+// Values below 16 get a bucket each; above that the top four bits pick it
+static int bucketIndex(uint64_t value) {
+    const uint64_t subBuckets = 1ULL << Histogram::SubBucketBits;
+    if (value < 2 * subBuckets) return static_cast<int>(value);
+    int shift = highestBit64(value) - Histogram::SubBucketBits;
+    return (shift << Histogram::SubBucketBits) + static_cast<int>(value >> shift);
+}
+
+static uint64_t bucketUpperBound(int index) {
+    const int subBuckets = 1 << Histogram::SubBucketBits;
+    if (index < 2 * subBuckets) return static_cast<uint64_t>(index);
+    int shift = (index >> Histogram::SubBucketBits) - 1;
+    uint64_t mantissa = static_cast<uint64_t>(index & (subBuckets - 1)) + subBuckets;
+    return ((mantissa + 1) << shift) - 1;
+}
+
+Histogram::Histogram() : total(0), valueSum(0), maxValue(0) {
+    for (auto& bucket : buckets) bucket.store(0, std::memory_order_relaxed);
+}
+
+void Histogram::record(uint64_t value) {
+    buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+    valueSum.fetch_add(value, std::memory_order_relaxed);
+    uint64_t seen = maxValue.load(std::memory_order_relaxed);
+    while (value > seen && !maxValue.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {}
+}
+
+uint64_t Histogram::percentile(double p) const {
+    uint64_t n = count();
+    if (n == 0) return 0;
+    uint64_t rank = static_cast<uint64_t>(p * static_cast<double>(n) + 0.5);
+    if (rank < 1) rank = 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < BucketCount; ++i) {
+        seen += buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank) return std::min(bucketUpperBound(i), max());
+    }
+    return max();
+}
+
+Metrics& Metrics::getInstance() {
+    static Metrics instance;
+    return instance;
+}
+
+Counter& Metrics::counter(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto& counter = counters[name];
+    if (!counter) counter.reset(new Counter());
+    return *counter;
+}
+
+Histogram& Metrics::histogram(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto& histogram = histograms[name];
+    if (!histogram) histogram.reset(new Histogram());
+    return *histogram;
+}
+
+std::string Metrics::toJson() const {
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    std::lock_guard<std::mutex> lock(mtx);
+
+    writer.StartObject();
+    writer.Key("counters");
+    writer.StartObject();
+    for (const auto& entry : counters) {
+        writer.Key(entry.first.c_str());
+        writer.Uint64(entry.second->get());
+    }
+    writer.EndObject();
+
+    writer.Key("histograms");
+    writer.StartObject();
+    for (const auto& entry : histograms) {
+        const Histogram& histogram = *entry.second;
+        writer.Key(entry.first.c_str());
+        writer.StartObject();
+        writer.Key("count");
+        writer.Uint64(histogram.count());
+        writer.Key("sum");
+        writer.Uint64(histogram.sum());
+        writer.Key("mean");
+        writer.Double(histogram.count() ? static_cast<double>(histogram.sum()) / histogram.count() : 0.0);
+        writer.Key("p50");
+        writer.Uint64(histogram.percentile(0.50));
+        writer.Key("p99");
+        writer.Uint64(histogram.percentile(0.99));
+        writer.Key("max");
+        writer.Uint64(histogram.max());
+        writer.EndObject();
+    }
+    writer.EndObject();
+    writer.EndObject();
+    return buffer.GetString();
+}
+
+bool Metrics::writeJson(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        Logger::getInstance().log("Failed to save file: " + path);
+        return false;
+    }
+    file << toJson();
+    return true;
+}
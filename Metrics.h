@@ -0,0 +1,97 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// Set to 0 to compile every METRICS_* macro out, arguments included
+#ifndef METRICS_ENABLED
+#define METRICS_ENABLED 1
+#endif
+
+class Counter {
+public:
+    void add(uint64_t n = 1) { value.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t get() const { return value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> value{ 0 };
+};
+
+// Log-linear histogram: every power of two is split into 8 buckets, so a
+// percentile is reported to within 12.5% of the recorded value. Recording is
+// a couple of relaxed atomic adds and never takes a lock.
+class Histogram {
+public:
+    Histogram();
+    void record(uint64_t value);
+    uint64_t count() const { return total.load(std::memory_order_relaxed); }
+    uint64_t sum() const { return valueSum.load(std::memory_order_relaxed); }
+    uint64_t max() const { return maxValue.load(std::memory_order_relaxed); }
+    // Upper bound of the bucket holding the p-th fraction of the values, p in [0, 1]
+    uint64_t percentile(double p) const;
+
+    static const int SubBucketBits = 3;
+    static const int BucketCount = (64 - SubBucketBits + 1) << SubBucketBits;
+
+private:
+    std::atomic<uint64_t> buckets[BucketCount];
+    std::atomic<uint64_t> total;
+    std::atomic<uint64_t> valueSum;
+    std::atomic<uint64_t> maxValue;
+};
+
+// Process-wide registry of named counters and histograms. Metrics live as long
+// as the registry, so call sites can keep the reference they get back.
+class Metrics {
+public:
+    static Metrics& getInstance();
+    Counter& counter(const std::string& name);
+    Histogram& histogram(const std::string& name);
+
+    // {"counters": {name: value}, "histograms": {name: {count, sum, mean, p50, p99, max}}}
+    std::string toJson() const;
+    bool writeJson(const std::string& path) const;
+
+private:
+    Metrics() = default;
+    mutable std::mutex mtx;
+    std::map<std::string, std::unique_ptr<Counter>> counters;
+    std::map<std::string, std::unique_ptr<Histogram>> histograms;
+};
+
+// Records how long the enclosing scope took, in microseconds
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Histogram& histogram) : histogram(histogram), start(std::chrono::steady_clock::now()) {}
+    ~ScopedTimer() {
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        histogram.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()));
+    }
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    Histogram& histogram;
+    std::chrono::steady_clock::time_point start;
+};
+
+// The registry lookup runs once per call site; name must be a constant
+#if METRICS_ENABLED
+#define METRICS_CONCAT_(a, b) a##b
+#define METRICS_CONCAT(a, b) METRICS_CONCAT_(a, b)
+#define METRICS_TIMER(name) \
+    static Histogram& METRICS_CONCAT(metricsHistogram, __LINE__) = Metrics::getInstance().histogram(name); \
+    ScopedTimer METRICS_CONCAT(metricsTimer, __LINE__)(METRICS_CONCAT(metricsHistogram, __LINE__))
+#define METRICS_COUNT(name, n) \
+    do { static Counter& metricsCounter = Metrics::getInstance().counter(name); metricsCounter.add(n); } while (0)
+#define METRICS_RECORD(name, value) \
+    do { static Histogram& metricsHistogram = Metrics::getInstance().histogram(name); metricsHistogram.record(value); } while (0)
+#else
+#define METRICS_TIMER(name) ((void)0)
+#define METRICS_COUNT(name, n) ((void)0)
+#define METRICS_RECORD(name, value) ((void)0)
+#endif
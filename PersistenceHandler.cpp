@@ -73,7 +73,7 @@ std::vector<Candidate> PersistenceHandler::loadFromFile(const std::string& filen
         return {};
     }
 
-    Logger::getInstance().log("Parsing JSON file Filter Data: " + filename);
+    LOG_DEBUG("Parsing JSON file Filter Data: " + filename);
 
     // Retrieve filterData
     if (doc.HasMember("filterData") && doc["filterData"].IsObject()) {
@@ -132,7 +132,7 @@ std::vector<Candidate> PersistenceHandler::loadFromFile(const std::string& filen
         }
     }
 
-    Logger::getInstance().log("Parsing JSON file Filter Candidates: " + filename);
+    LOG_DEBUG("Parsing JSON file Filter Candidates: " + filename);
 
     // Retrieve candidates
     std::vector<Candidate> candidates;
@@ -0,0 +1,37 @@
+#include "ResultSet.h"
+
+ResultSet::ResultSet() : ranker(new IncrementalRanker(data, bitsets)) {}
+
+void ResultSet::load(const std::vector<Candidate>& candidates) {
+    data = CandidateStore(candidates);
+    bitsets.build(data);
+    ranker.reset(new IncrementalRanker(data, bitsets));
+    shown = data.allRows();
+    scores.resize(candidates.size());
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        scores[i] = candidates[i].score;
+    }
+    ranked = false;
+}
+
+void ResultSet::rank(const ScoringWeights& weights) {
+    if (ranked) {
+        ranker->update(weights);
+    }
+    else {
+        ranker->rank(shown, weights);
+        ranked = true;
+    }
+    shown = ranker->ranked();
+    for (RowIndex row : shown) {
+        scores[row] = ranker->scores()[row];
+    }
+}
+
+std::vector<Candidate> ResultSet::toCandidates() const {
+    std::vector<Candidate> candidates = data.toCandidates(shown);
+    for (size_t i = 0; i < shown.size(); ++i) {
+        candidates[i].score = scores[shown[i]];
+    }
+    return candidates;
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include "CandidateStore.h"
+#include "ScoringEngine.h"
+#include "SkillBitset.h"
+#include <memory>
+#include <vector>
+
+// The candidates MyFrame works on and the part of them currently shown. The
+// loaded data lives in a CandidateStore; ranking and saving work on row
+// indices and a per-row score column, and the list control only renders it.
+class ResultSet {
+public:
+    ResultSet();
+    ResultSet(const ResultSet&) = delete;
+    ResultSet& operator=(const ResultSet&) = delete;
+
+    // Replaces the loaded data and shows all of it in load order
+    void load(const std::vector<Candidate>& candidates);
+    // Ranks the shown rows; ranking the same rows again only applies the weight changes
+    void rank(const ScoringWeights& weights);
+
+    const CandidateStore& store() const { return data; }
+    const Selection& rows() const { return shown; }
+    size_t size() const { return shown.size(); }
+    double score(RowIndex row) const { return scores[row]; }
+
+    // The shown candidates, in display order and with their scores
+    std::vector<Candidate> toCandidates() const;
+
+private:
+    CandidateStore data;
+    SkillBitsetIndex bitsets;
+    std::unique_ptr<IncrementalRanker> ranker;
+    Selection shown;
+    std::vector<double> scores; // By row
+    bool ranked = false;        // The ranker holds the shown rows
+};
@@ -1,6 +1,67 @@
 #include "ScoringEngine.h"
+#include "Metrics.h"
 #include <algorithm>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SCORING_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SCORING_SSE2
+#endif
+
+namespace {
+
+std::vector<float> resolveUniversityWeights(const CandidateStore& store, const ScoringWeights& weights) {
+    std::vector<float> uniWeights(store.universities().size(), 0.0f);
+    for (const auto& entry : weights.universityWeights) {
+        uint32_t id;
+        if (store.universities().find(entry.first, id)) uniWeights[id] = entry.second;
+    }
+    return uniWeights;
+}
+
+// Higher score first, then lower index
+template <typename Scores>
+struct ScoreOrder {
+    const Scores& scores;
+    template <typename Index>
+    bool operator()(Index a, Index b) const {
+        if (scores[a] != scores[b]) return scores[a] > scores[b];
+        return a < b;
+    }
+};
+
+// scores[i] = gpas[i] * gpaWeight + skillTerms[i] + uniWeights[universities[i]],
+// added in double precision in the same order as calculateScore
+void combineTerms(const double* gpas, const uint32_t* universities, const float* uniWeights, float gpaWeight, float* scores, size_t count) {
+    size_t i = 0;
+#if defined(SCORING_AVX2)
+    const __m256d weight = _mm256_set1_pd(gpaWeight);
+    for (; i + 4 <= count; i += 4) {
+        __m256d gpaTerm = _mm256_mul_pd(_mm256_loadu_pd(gpas + i), weight);
+        __m256d skillTerm = _mm256_cvtps_pd(_mm_loadu_ps(scores + i));
+        __m128i ids = _mm_loadu_si128(reinterpret_cast<const __m128i*>(universities + i));
+        __m256d uniTerm = _mm256_cvtps_pd(_mm_i32gather_ps(uniWeights, ids, 4));
+        _mm_storeu_ps(scores + i, _mm256_cvtpd_ps(_mm256_add_pd(_mm256_add_pd(gpaTerm, skillTerm), uniTerm)));
+    }
+#elif defined(SCORING_SSE2)
+    const __m128d weight = _mm_set1_pd(gpaWeight);
+    for (; i + 2 <= count; i += 2) {
+        __m128d gpaTerm = _mm_mul_pd(_mm_loadu_pd(gpas + i), weight);
+        __m128d skillTerm = _mm_set_pd(scores[i + 1], scores[i]);
+        __m128d uniTerm = _mm_set_pd(uniWeights[universities[i + 1]], uniWeights[universities[i]]);
+        __m128 sum = _mm_cvtpd_ps(_mm_add_pd(_mm_add_pd(gpaTerm, skillTerm), uniTerm));
+        _mm_storel_pi(reinterpret_cast<__m64*>(scores + i), sum);
+    }
+#endif
+    for (; i < count; ++i) {
+        scores[i] = static_cast<float>(gpas[i] * gpaWeight + scores[i] + uniWeights[universities[i]]);
+    }
+}
+
+}
+
 float ScoringEngine::calculateScore(Candidate& candidate, const ScoringWeights& weights) {
     // University weight
     float uniWeight = 0.0f;
@@ -23,10 +84,188 @@ float ScoringEngine::calculateScore(Candidate& candidate, const ScoringWeights&
 }
 
 std::vector<Candidate> ScoringEngine::rankCandidates(std::vector<Candidate>& candidates, const ScoringWeights& weights) {
+    METRICS_TIMER("rank_us");
     
 	for (auto& c : candidates) {
 		calculateScore(c, weights);
 	}
-	std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) { return a.score > b.score; });
+	std::stable_sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) { return a.score > b.score; });
     return candidates;
+}
+
+void ScoringEngine::calculateScores(const CandidateStore& store, const Selection& rows, const ScoringWeights& weights, std::vector<float>& scores) {
+    // Resolve university weights and required skills to the store's ids once
+    std::vector<float> uniWeights = resolveUniversityWeights(store, weights);
+    std::vector<char> requiredSkill(store.skills().size(), 0);
+    for (const auto& skill : weights.requiredSkills) {
+        uint32_t id;
+        if (store.skills().find(skill, id)) requiredSkill[id] = 1;
+    }
+
+    scores.resize(store.size(), 0.0f);
+    for (RowIndex row : rows) {
+        int matchingSkills = 0;
+        for (const uint32_t* it = store.skillsBegin(row); it != store.skillsEnd(row); ++it) {
+            matchingSkills += requiredSkill[*it];
+        }
+        scores[row] = static_cast<float>(store.gpa(row) * weights.gpaWeight + matchingSkills * weights.skillWeight + uniWeights[store.universityId(row)]);
+    }
+}
+
+Selection ScoringEngine::rankCandidates(const CandidateStore& store, const Selection& rows, const ScoringWeights& weights, std::vector<float>& scores) {
+    METRICS_TIMER("rank_us");
+    calculateScores(store, rows, weights, scores);
+    Selection ranked(rows);
+    std::stable_sort(ranked.begin(), ranked.end(), [&scores](RowIndex a, RowIndex b) { return scores[a] > scores[b]; });
+    return ranked;
+}
+
+void ScoringEngine::calculateScores(const CandidateStore& store, const SkillBitsetIndex& bitsets, const Selection& rows, const ScoringWeights& weights, std::vector<float>& scores) {
+    if (bitsets.rows() != store.size()) {
+        calculateScores(store, rows, weights, scores);
+        return;
+    }
+    std::vector<float> uniWeights = resolveUniversityWeights(store, weights);
+    std::vector<uint32_t> required;
+    for (const auto& skill : weights.requiredSkills) {
+        uint32_t id;
+        if (store.skills().find(skill, id)) required.push_back(id);
+    }
+    std::vector<uint64_t> mask;
+    bitsets.makeMask(required, mask);
+
+    scores.resize(store.size(), 0.0f);
+    // A small selection is scored row by row; otherwise every row is scored,
+    // which keeps the loops branch-free and contiguous
+    if (rows.size() * 4 < store.size()) {
+        for (RowIndex row : rows) {
+            unsigned matchingSkills = 0;
+            for (size_t word = 0; word < mask.size(); ++word) {
+                if (mask[word]) matchingSkills += popcount64(bitsets.column(word)[row] & mask[word]);
+            }
+            float skillTerm = matchingSkills * weights.skillWeight;
+            scores[row] = static_cast<float>(store.gpa(row) * weights.gpaWeight + skillTerm + uniWeights[store.universityId(row)]);
+        }
+        return;
+    }
+
+    size_t count = store.size();
+    std::vector<uint16_t> matchingSkills(count, 0);
+    for (size_t word = 0; word < mask.size(); ++word) {
+        if (!mask[word]) continue;
+        const uint64_t* column = bitsets.column(word);
+        const uint64_t bits = mask[word];
+        for (size_t i = 0; i < count; ++i) {
+            matchingSkills[i] += static_cast<uint16_t>(popcount64(column[i] & bits));
+        }
+    }
+    for (size_t i = 0; i < count; ++i) {
+        scores[i] = matchingSkills[i] * weights.skillWeight;
+    }
+    combineTerms(store.gpas().data(), store.universityIds().data(), uniWeights.data(), weights.gpaWeight, scores.data(), count);
+}
+
+Selection ScoringEngine::rankCandidates(const CandidateStore& store, const SkillBitsetIndex& bitsets, const Selection& rows, const ScoringWeights& weights, std::vector<float>& scores) {
+    METRICS_TIMER("rank_us");
+    calculateScores(store, bitsets, rows, weights, scores);
+    Selection ranked(rows);
+    std::stable_sort(ranked.begin(), ranked.end(), [&scores](RowIndex a, RowIndex b) { return scores[a] > scores[b]; });
+    return ranked;
+}
+
+IncrementalRanker::IncrementalRanker(const CandidateStore& store, const SkillBitsetIndex& bitsets)
+    : store(store), bitsets(bitsets) {}
+
+void IncrementalRanker::resolveWeights(const ScoringWeights& weights, std::vector<float>& uniWeights, std::vector<uint32_t>& skillIds) const {
+    uniWeights = resolveUniversityWeights(store, weights);
+    skillIds.clear();
+    for (const auto& skill : weights.requiredSkills) {
+        uint32_t id;
+        if (store.skills().find(skill, id) && id / 64 < bitsets.words()) skillIds.push_back(id);
+    }
+    std::sort(skillIds.begin(), skillIds.end());
+    skillIds.erase(std::unique(skillIds.begin(), skillIds.end()), skillIds.end());
+}
+
+void IncrementalRanker::recountSkill(uint32_t skillId, int delta) {
+    const uint64_t* column = bitsets.column(skillId / 64);
+    const uint64_t bit = uint64_t(1) << (skillId % 64);
+    for (RowIndex row : rankedRows) {
+        if (column[row] & bit) matchingSkills[row] = static_cast<uint16_t>(matchingSkills[row] + delta);
+    }
+}
+
+// Same arithmetic as ScoringEngine::calculateScores, so both rank alike
+float IncrementalRanker::score(RowIndex row) const {
+    float skillTerm = matchingSkills[row] * currentWeights.skillWeight;
+    return static_cast<float>(store.gpa(row) * currentWeights.gpaWeight + skillTerm + uniWeights[store.universityId(row)]);
+}
+
+void IncrementalRanker::rank(const Selection& rows, const ScoringWeights& weights) {
+    METRICS_TIMER("rank_us");
+    currentWeights = weights;
+    resolveWeights(weights, uniWeights, requiredIds);
+    rankedRows = rows;
+    matchingSkills.assign(store.size(), 0);
+    scoreColumn.assign(store.size(), 0.0f);
+    if (bitsets.rows() != store.size()) {
+        // Without current bitsets the skills are counted from the store itself
+        for (RowIndex row : rankedRows) {
+            for (const uint32_t* it = store.skillsBegin(row); it != store.skillsEnd(row); ++it) {
+                if (std::binary_search(requiredIds.begin(), requiredIds.end(), *it)) matchingSkills[row]++;
+            }
+        }
+    }
+    else {
+        for (uint32_t id : requiredIds) {
+            recountSkill(id, 1);
+        }
+    }
+    for (RowIndex row : rankedRows) {
+        scoreColumn[row] = score(row);
+    }
+    std::sort(rankedRows.begin(), rankedRows.end(), ScoreOrder<std::vector<float>>{ scoreColumn });
+}
+
+void IncrementalRanker::update(const ScoringWeights& weights) {
+    if (bitsets.rows() != store.size()) {
+        rank(rankedRows, weights);
+        return;
+    }
+    METRICS_TIMER("rank_us");
+    std::vector<float> newUniWeights;
+    std::vector<uint32_t> newRequiredIds;
+    resolveWeights(weights, newUniWeights, newRequiredIds);
+
+    std::vector<uint32_t> added, removed;
+    std::set_difference(newRequiredIds.begin(), newRequiredIds.end(), requiredIds.begin(), requiredIds.end(), std::back_inserter(added));
+    std::set_difference(requiredIds.begin(), requiredIds.end(), newRequiredIds.begin(), newRequiredIds.end(), std::back_inserter(removed));
+    for (uint32_t id : added) {
+        recountSkill(id, 1);
+    }
+    for (uint32_t id : removed) {
+        recountSkill(id, -1);
+    }
+    currentWeights = weights;
+    uniWeights.swap(newUniWeights);
+    requiredIds.swap(newRequiredIds);
+
+    // Rows whose score is unchanged keep their relative order; only the
+    // changed ones are sorted, then both runs are merged
+    Selection unchanged, changed;
+    unchanged.reserve(rankedRows.size());
+    for (RowIndex row : rankedRows) {
+        float newScore = score(row);
+        if (newScore == scoreColumn[row]) {
+            unchanged.push_back(row);
+        }
+        else {
+            scoreColumn[row] = newScore;
+            changed.push_back(row);
+        }
+    }
+    if (changed.empty()) return;
+    ScoreOrder<std::vector<float>> less{ scoreColumn };
+    std::sort(changed.begin(), changed.end(), less);
+    std::merge(unchanged.begin(), unchanged.end(), changed.begin(), changed.end(), rankedRows.begin(), less);
 }
\ No newline at end of file
@@ -1,5 +1,7 @@
 #pragma once
+#include "CandidateStore.h"
 #include "DataParser.h"
+#include "SkillBitset.h"
 #include <map>
 
 struct ScoringWeights {
@@ -13,4 +15,46 @@ class ScoringEngine {
 public:
     static float calculateScore(Candidate& candidate, const ScoringWeights& weights);
     static std::vector<Candidate> rankCandidates(std::vector<Candidate>& candidates, const ScoringWeights& weights);
+
+    // CandidateStore overloads: scores is indexed by row and sized to the store,
+    // and the ranked rows are returned instead of reordered copies
+    static void calculateScores(const CandidateStore& store, const Selection& rows, const ScoringWeights& weights, std::vector<float>& scores);
+    static Selection rankCandidates(const CandidateStore& store, const Selection& rows, const ScoringWeights& weights, std::vector<float>& scores);
+
+    // Batch kernel: weights are resolved to a university-id table and a skill
+    // mask, and whole columns are scored with SIMD (AVX2 or SSE2). A skill
+    // listed twice by one candidate matches once.
+    static void calculateScores(const CandidateStore& store, const SkillBitsetIndex& bitsets, const Selection& rows, const ScoringWeights& weights, std::vector<float>& scores);
+    static Selection rankCandidates(const CandidateStore& store, const SkillBitsetIndex& bitsets, const Selection& rows, const ScoringWeights& weights, std::vector<float>& scores);
+};
+
+// Keeps the score components of a ranked selection (matched-skill count per
+// row and the resolved weight tables) so a weight change only redoes the part
+// it affects: a new or dropped required skill recounts one bitset column,
+// other changes are plain arithmetic. Only rows whose score changed are
+// re-sorted and merged back into the existing order.
+class IncrementalRanker {
+public:
+    IncrementalRanker(const CandidateStore& store, const SkillBitsetIndex& bitsets);
+
+    void rank(const Selection& rows, const ScoringWeights& weights);
+    void update(const ScoringWeights& weights);
+
+    const Selection& ranked() const { return rankedRows; }
+    const std::vector<float>& scores() const { return scoreColumn; } // Indexed by row
+    const ScoringWeights& weights() const { return currentWeights; }
+
+private:
+    void resolveWeights(const ScoringWeights& weights, std::vector<float>& uniWeights, std::vector<uint32_t>& skillIds) const;
+    void recountSkill(uint32_t skillId, int delta);
+    float score(RowIndex row) const;
+
+    const CandidateStore& store;
+    const SkillBitsetIndex& bitsets;
+    ScoringWeights currentWeights;
+    std::vector<float> uniWeights;        // By university id
+    std::vector<uint32_t> requiredIds;    // Sorted skill ids
+    std::vector<uint16_t> matchingSkills; // By row
+    std::vector<float> scoreColumn;       // By row
+    Selection rankedRows;
 };
\ No newline at end of file
@@ -0,0 +1,113 @@
+#include "SkillBitset.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SKILLBITSET_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SKILLBITSET_SSE2
+#endif
+
+namespace {
+
+// match[i] &= ((column[i] & bits) == bits) for every row
+void matchWord(const uint64_t* column, size_t count, uint64_t bits, uint8_t* match) {
+    size_t i = 0;
+#if defined(SKILLBITSET_AVX2)
+    const __m256i wanted = _mm256_set1_epi64x(static_cast<long long>(bits));
+    for (; i + 4 <= count; i += 4) {
+        __m256i words = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(column + i));
+        __m256i equal = _mm256_cmpeq_epi64(_mm256_and_si256(words, wanted), wanted);
+        int lanes = _mm256_movemask_pd(_mm256_castsi256_pd(equal));
+        match[i] &= lanes & 1;
+        match[i + 1] &= (lanes >> 1) & 1;
+        match[i + 2] &= (lanes >> 2) & 1;
+        match[i + 3] &= (lanes >> 3) & 1;
+    }
+#elif defined(SKILLBITSET_SSE2)
+    // SSE2 has no 64-bit compare: a row matches when both 32-bit halves of
+    // (word & bits) ^ bits are zero
+    const __m128i wanted = _mm_set1_epi64x(static_cast<long long>(bits));
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 2 <= count; i += 2) {
+        __m128i words = _mm_loadu_si128(reinterpret_cast<const __m128i*>(column + i));
+        __m128i missing = _mm_xor_si128(_mm_and_si128(words, wanted), wanted);
+        int lanes = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(missing, zero)));
+        match[i] &= (lanes & 0x3) == 0x3;
+        match[i + 1] &= (lanes & 0xC) == 0xC;
+    }
+#endif
+    for (; i < count; ++i) {
+        match[i] &= (column[i] & bits) == bits;
+    }
+}
+
+}
+
+SkillBitsetIndex::SkillBitsetIndex(const CandidateStore& store) {
+    build(store);
+}
+
+void SkillBitsetIndex::build(const CandidateStore& store) {
+    rowCount = store.size();
+    wordCount = (store.skills().size() + 63) / 64;
+    columns.assign(rowCount * wordCount, 0);
+    for (size_t row = 0; row < rowCount; ++row) {
+        RowIndex r = static_cast<RowIndex>(row);
+        for (const uint32_t* it = store.skillsBegin(r); it != store.skillsEnd(r); ++it) {
+            columns[(*it / 64) * rowCount + row] |= uint64_t(1) << (*it % 64);
+        }
+    }
+}
+
+bool SkillBitsetIndex::makeMask(const std::vector<uint32_t>& skillIds, std::vector<uint64_t>& mask) const {
+    mask.assign(wordCount, 0);
+    for (uint32_t id : skillIds) {
+        if (id / 64 >= wordCount) return false;
+        mask[id / 64] |= uint64_t(1) << (id % 64);
+    }
+    return true;
+}
+
+bool SkillBitsetIndex::hasAll(RowIndex row, const std::vector<uint64_t>& mask) const {
+    for (size_t word = 0; word < mask.size(); ++word) {
+        uint64_t bits = mask[word];
+        if (bits && (columns[word * rowCount + row] & bits) != bits) return false;
+    }
+    return true;
+}
+
+// Only the words holding required bits are streamed
+void SkillBitsetIndex::matchAll(const std::vector<uint64_t>& mask, std::vector<uint8_t>& match) const {
+    match.assign(rowCount, 1);
+    for (size_t word = 0; word < mask.size(); ++word) {
+        if (mask[word]) matchWord(columns.data() + word * rowCount, rowCount, mask[word], match.data());
+    }
+}
+
+Selection SkillBitsetIndex::rowsWithAll(const std::vector<uint64_t>& mask) const {
+    std::vector<uint8_t> match;
+    matchAll(mask, match);
+    Selection result;
+    for (size_t row = 0; row < rowCount; ++row) {
+        if (match[row]) result.push_back(static_cast<RowIndex>(row));
+    }
+    return result;
+}
+
+Selection SkillBitsetIndex::filter(const Selection& rows, const std::vector<uint64_t>& mask) const {
+    Selection result;
+    // A small selection is cheaper to probe row by row than to scan every row
+    if (rows.size() * 4 < rowCount) {
+        for (RowIndex row : rows) {
+            if (hasAll(row, mask)) result.push_back(row);
+        }
+        return result;
+    }
+    std::vector<uint8_t> match;
+    matchAll(mask, match);
+    for (RowIndex row : rows) {
+        if (match[row]) result.push_back(row);
+    }
+    return result;
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include "CandidateStore.h"
+#include <cstdint>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Portable bit count; MSVC's __popcnt64 would need a POPCNT check at runtime
+inline unsigned popcount64(uint64_t word) {
+#if defined(__GNUC__)
+    return static_cast<unsigned>(__builtin_popcountll(word));
+#else
+    word = word - ((word >> 1) & 0x5555555555555555ULL);
+    word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+    word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return static_cast<unsigned>((word * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+// Index of the lowest set bit; word must not be zero
+inline unsigned countTrailingZeros64(uint64_t word) {
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return static_cast<unsigned>(index);
+#elif defined(__GNUC__)
+    return static_cast<unsigned>(__builtin_ctzll(word));
+#else
+    unsigned index = 0;
+    while (!(word & 1)) {
+        word >>= 1;
+        index++;
+    }
+    return index;
+#endif
+}
+
+// Skills of every row of a CandidateStore encoded as a fixed-width bitset over
+// the store's skill dictionary. Storage is word-major (all rows of word 0,
+// then all rows of word 1, ...), so a "has all required skills" check only
+// streams the words that contain required bits and runs as a SIMD AND/compare
+// across several candidates at once (AVX2 or SSE2, with a scalar fallback).
+class SkillBitsetIndex {
+public:
+    SkillBitsetIndex() = default;
+    explicit SkillBitsetIndex(const CandidateStore& store);
+
+    void build(const CandidateStore& store);
+    size_t rows() const { return rowCount; }
+    size_t words() const { return wordCount; }
+    // Word of every row, rows() entries
+    const uint64_t* column(size_t word) const { return columns.data() + word * rowCount; }
+    bool hasAll(RowIndex row, const std::vector<uint64_t>& mask) const;
+
+    // Mask with one bit per skill id; false if an id is outside the dictionary
+    bool makeMask(const std::vector<uint32_t>& skillIds, std::vector<uint64_t>& mask) const;
+
+    // Every row having all the skills in the mask, in row order
+    Selection rowsWithAll(const std::vector<uint64_t>& mask) const;
+    // The subset of rows having all the skills in the mask, keeping their order
+    Selection filter(const Selection& rows, const std::vector<uint64_t>& mask) const;
+
+private:
+    void matchAll(const std::vector<uint64_t>& mask, std::vector<uint8_t>& match) const;
+
+    size_t rowCount = 0;
+    size_t wordCount = 0;
+    std::vector<uint64_t> columns; // columns[word * rowCount + row]
+};
@@ -0,0 +1,236 @@
+#include "XmlPullReader.h"
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+void appendUtf8(std::string& out, unsigned long cp) {
+    if (cp < 0x80) {
+        out += static_cast<char>(cp);
+    }
+    else if (cp < 0x800) {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+    else if (cp < 0x10000) {
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+    else {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+}
+
+XmlPullReader::XmlPullReader(std::istream& input, size_t chunkSize)
+    : input(&input), chunk(chunkSize > 0 ? chunkSize : 1), cur(nullptr), end(nullptr) {}
+
+XmlPullReader::XmlPullReader(const std::string& data)
+    : XmlPullReader(data.data(), data.size()) {}
+
+XmlPullReader::XmlPullReader(const char* data, size_t size)
+    : input(nullptr), cur(data), end(data + size) {}
+
+bool XmlPullReader::refill() {
+    if (!input) return false;
+    input->read(chunk.data(), chunk.size());
+    std::streamsize count = input->gcount();
+    if (count <= 0) return false;
+    cur = chunk.data();
+    end = cur + count;
+    return true;
+}
+
+bool XmlPullReader::peek(char& c) {
+    if (cur == end && !refill()) return false;
+    c = *cur;
+    return true;
+}
+
+bool XmlPullReader::get(char& c) {
+    if (!peek(c)) return false;
+    ++cur;
+    return true;
+}
+
+// Consumes input up to and including the terminator
+bool XmlPullReader::skipUntil(const char* terminator) {
+    size_t length = std::strlen(terminator);
+    std::string window;
+    char c;
+    while (get(c)) {
+        window += c;
+        if (window.size() > length) window.erase(0, 1);
+        if (window == terminator) return true;
+    }
+    return false;
+}
+
+XmlPullReader::Event XmlPullReader::fail(const std::string& message) {
+    failed = true;
+    errorMessage = message;
+    return Event::Error;
+}
+
+bool XmlPullReader::readName(std::string& out) {
+    out.clear();
+    char c;
+    while (peek(c) && !isSpace(c) && c != '>' && c != '/' && c != '=') {
+        out += c;
+        ++cur;
+    }
+    return !out.empty();
+}
+
+// Called after '&'; appends the decoded character or the raw text if unknown
+bool XmlPullReader::decodeEntity(std::string& out) {
+    std::string entity;
+    char c;
+    while (entity.size() < 10 && get(c)) {
+        if (c == ';') {
+            if (entity == "lt") out += '<';
+            else if (entity == "gt") out += '>';
+            else if (entity == "amp") out += '&';
+            else if (entity == "quot") out += '"';
+            else if (entity == "apos") out += '\'';
+            else if (entity.size() > 2 && entity[0] == '#' && (entity[1] == 'x' || entity[1] == 'X')) appendUtf8(out, std::strtoul(entity.c_str() + 2, nullptr, 16));
+            else if (entity.size() > 1 && entity[0] == '#') appendUtf8(out, std::strtoul(entity.c_str() + 1, nullptr, 10));
+            else out += "&" + entity + ";";
+            return true;
+        }
+        if (c == '<') {
+            --cur; // Leave the tag for the caller
+            break;
+        }
+        entity += c;
+    }
+    out += "&" + entity;
+    return false;
+}
+
+XmlPullReader::Event XmlPullReader::readText() {
+    currentText.clear();
+    char c;
+    while (peek(c) && c != '<') {
+        ++cur;
+        if (c == '&') decodeEntity(currentText);
+        else currentText += c;
+    }
+    return Event::Text;
+}
+
+// Marks markup that produces no event (prolog, comment, DOCTYPE)
+XmlPullReader::Event XmlPullReader::skipped() {
+    skippedMarkup = true;
+    return Event::Text;
+}
+
+XmlPullReader::Event XmlPullReader::readMarkup() {
+    char c;
+    get(c); // '<'
+    if (!peek(c)) return fail("Unexpected end of document in tag");
+
+    if (c == '?') {
+        if (!skipUntil("?>")) return fail("Unterminated processing instruction");
+        return skipped();
+    }
+
+    if (c == '!') {
+        ++cur;
+        if (!peek(c)) return fail("Unexpected end of document in tag");
+        if (c == '-') {
+            if (!skipUntil("-->")) return fail("Unterminated comment");
+            return skipped();
+        }
+        if (c == '[') {
+            if (!skipUntil("[CDATA[")) return fail("Malformed CDATA section");
+            currentText.clear();
+            while (get(c)) {
+                currentText += c;
+                if (currentText.size() >= 3 && currentText.compare(currentText.size() - 3, 3, "]]>") == 0) {
+                    currentText.resize(currentText.size() - 3);
+                    return Event::Text;
+                }
+            }
+            return fail("Unterminated CDATA section");
+        }
+        // DOCTYPE, possibly with an internal subset in brackets
+        int brackets = 0;
+        while (get(c)) {
+            if (c == '[') brackets++;
+            else if (c == ']') brackets--;
+            else if (c == '>' && brackets <= 0) return skipped();
+        }
+        return fail("Unterminated DOCTYPE");
+    }
+
+    if (c == '/') {
+        ++cur;
+        std::string closing;
+        if (!readName(closing)) return fail("Malformed closing tag");
+        while (peek(c) && isSpace(c)) ++cur;
+        if (!get(c) || c != '>') return fail("Malformed closing tag </" + closing + ">");
+        if (openElements.empty() || openElements.back() != closing) {
+            return fail("Mismatched closing tag </" + closing + ">" + (openElements.empty() ? std::string() : ", expected </" + openElements.back() + ">"));
+        }
+        openElements.pop_back();
+        currentName = closing;
+        return Event::EndElement;
+    }
+
+    std::string opening;
+    if (!readName(opening)) return fail("Malformed tag");
+    // Attributes are not used by the feeds; skip them, honouring quoted values
+    for (;;) {
+        if (!get(c)) return fail("Unexpected end of document in <" + opening + ">");
+        if (c == '>') break;
+        if (c == '/') {
+            if (!get(c) || c != '>') return fail("Malformed tag <" + opening + ">");
+            pendingEnd = true;
+            break;
+        }
+        if (c == '"' || c == '\'') {
+            char quote = c;
+            while (get(c) && c != quote) {}
+            if (c != quote) return fail("Unterminated attribute in <" + opening + ">");
+        }
+    }
+    openElements.push_back(opening);
+    currentName = opening;
+    return Event::StartElement;
+}
+
+XmlPullReader::Event XmlPullReader::next() {
+    if (failed) return Event::Error;
+    if (pendingEnd) {
+        pendingEnd = false;
+        currentName = openElements.back();
+        openElements.pop_back();
+        return Event::EndElement;
+    }
+
+    char c;
+    while (peek(c)) {
+        if (c == '<') {
+            skippedMarkup = false;
+            Event event = readMarkup();
+            if (skippedMarkup) continue;
+            return event;
+        }
+        readText();
+        if (!openElements.empty()) return Event::Text;
+        // Whitespace (or a byte order mark) outside the root element is ignored
+    }
+
+    if (!openElements.empty()) return fail("Unexpected end of document inside <" + openElements.back() + ">");
+    return Event::EndDocument;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <istream>
+#include <string>
+#include <vector>
+
+// Minimal forward-only XML tokenizer. It reads the input in fixed-size chunks
+// and reports one element or text event at a time, so memory does not grow
+// with the document. Prolog, comments, DOCTYPE and attributes are skipped,
+// CDATA is reported as text and the predefined/numeric entities are decoded.
+class XmlPullReader {
+public:
+    enum class Event { StartElement, EndElement, Text, EndDocument, Error };
+
+    explicit XmlPullReader(std::istream& input, size_t chunkSize = 64 * 1024);
+    explicit XmlPullReader(const std::string& data);
+    // Reads size bytes in place; they must outlive the reader
+    XmlPullReader(const char* data, size_t size);
+
+    Event next();
+    const std::string& name() const { return currentName; }
+    const std::string& text() const { return currentText; }
+    const std::string& error() const { return errorMessage; }
+    size_t depth() const { return openElements.size(); }
+
+private:
+    bool refill();
+    bool peek(char& c);
+    bool get(char& c);
+    bool skipUntil(const char* terminator);
+    Event fail(const std::string& message);
+    Event skipped();
+    Event readMarkup();
+    Event readText();
+    bool readName(std::string& out);
+    bool decodeEntity(std::string& out);
+
+    std::istream* input;
+    std::vector<char> chunk;
+    const char* cur;
+    const char* end;
+    std::vector<std::string> openElements;
+    std::string currentName;
+    std::string currentText;
+    std::string errorMessage;
+    bool pendingEnd = false; // Self-closing tag: EndElement is reported on the next call
+    bool skippedMarkup = false;
+    bool failed = false;
+};